@@ -0,0 +1,236 @@
+#include "Sweep.cpp"
+#include "WorkloadGenerator.cpp"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+
+// what came out of timing one stage
+struct BenchmarkResult {
+	
+	bool succeeded;
+	double seconds;	// wall time of the stage only, not of reading the workload first
+	long events;	// events the simulation went through, 0 for the other stages
+	long operations;	// operations in the metadata
+	long peakMemory;	// most memory ( KB ) the process running the stage ever used
+};
+
+// the benchmark times the parts of the simulator that matter for big
+// workloads on generated metadata of every size asked for: writing the
+// metadata, parsing it, ordering it for SJF & simulating it with every
+// policy.. every stage runs in a process of its own so the peak memory of
+// one stage does not hide the next one.. a row of CSV is printed for every
+// stage so runs can be compared by a script
+class Benchmark {
+	
+	public:
+		
+		// constructor, reads the config & the workload ( the workload file
+		// can be empty to use the default one ) & runs every size
+		Benchmark( string, string, vector<long> & );
+		
+		// runs every stage on a workload of the number of jobs
+		void runSize( long );
+		
+		// runs the stage in a child process & collects its result
+		BenchmarkResult runStage( string, string );
+		
+		// the part of the stage that runs in the child
+		BenchmarkResult stage( string, string );
+		
+		// prints the row of the stage
+		void printRow( string, long, BenchmarkResult & );
+		
+		Configure config; // cycle times & quantum the simulations use
+		WorkloadGenerator generator; // makes the metadata of every size
+};
+
+Benchmark::Benchmark( string configFile, string workloadFile, vector<long> &sizes ) {
+	
+	OS os;
+	
+	os.configureSystem( configFile );
+	config = os.systemConfig;
+	
+	// the simulations are timed without any output & always parse
+	config.logLevel = LOG_NONE;
+	config.traceCache = false;
+	config.streamWindow = 0;
+	config.metricsFile = "";
+	config.checkpointFile = "";
+	config.traceFile = "";
+	config.pace = 0;
+	
+	if( !workloadFile.empty() && !generator.readSettings( workloadFile ) ) {
+		
+		return;
+	}
+	
+	cout << "stage,jobs,operations,seconds,jobs_per_sec,events_per_sec,ns_per_op,peak_rss_kb" << endl;
+	
+	for( int i = 0; i < (int) sizes.size(); i++ ) {
+		
+		runSize( sizes[ i ] );
+	}
+}
+
+void Benchmark::runSize( long jobs ) {
+	
+	string metadata = "benchmark_" + to_string( jobs ) + ".txt";
+	const char *stages[] = { "generate", "parse", "SJF order", "FIFO", "SJF", "Round Robin", "SRTF", "MLFQ" };
+	
+	generator.jobs = jobs;
+	
+	for( int i = 0; i < 8; i++ ) {
+		
+		BenchmarkResult result = runStage( stages[ i ], metadata );
+		
+		if( !result.succeeded ) {
+			
+			cerr << "Error: benchmark stage " << stages[ i ] << " failed for " << jobs << " jobs" << endl;
+			break;
+		}
+		
+		printRow( stages[ i ], jobs, result );
+	}
+	
+	unlink( metadata.c_str() );
+}
+
+BenchmarkResult Benchmark::runStage( string name, string metadata ) {
+	
+	BenchmarkResult result;
+	int fds[ 2 ];
+	
+	result.succeeded = false;
+	
+	if( pipe( fds ) == -1 ) {
+		
+		return result;
+	}
+	
+	cout.flush();
+	
+	pid_t child = fork();
+	
+	if( child == 0 ) {
+		
+		result = stage( name, metadata );
+		
+		::close( fds[ 0 ] );
+		
+		bool sent = ( write( fds[ 1 ], &result, sizeof( result ) ) == sizeof( result ) );
+		
+		_exit( sent ? 0 : 1 );
+	}
+	
+	::close( fds[ 1 ] );
+	
+	if( child != -1 && read( fds[ 0 ], &result, sizeof( result ) ) != sizeof( result ) ) {
+		
+		result.succeeded = false;
+	}
+	
+	::close( fds[ 0 ] );
+	
+	// the peak memory of the child is only known once it is gone
+	struct rusage usage;
+	int status;
+	
+	if( child != -1 && wait4( child, &status, 0, &usage ) == child ) {
+		
+		result.peakMemory = usage.ru_maxrss;
+	}
+	
+	return result;
+}
+
+BenchmarkResult Benchmark::stage( string name, string metadata ) {
+	
+	BenchmarkResult result;
+	OS os;
+	chrono::steady_clock::time_point start;
+	
+	result.succeeded = false;
+	result.events = 0;
+	result.operations = 0;
+	result.peakMemory = 0;
+	
+	if( name == "generate" ) {
+		
+		start = chrono::steady_clock::now();
+		result.succeeded = generator.generate( metadata );
+		result.seconds = chrono::duration<double>( chrono::steady_clock::now() - start ).count();
+		result.operations = generator.operations;
+		
+		return result;
+	}
+	
+	os.systemConfig = config;
+	os.systemConfig.file = metadata;
+	
+	if( name != "parse" && name != "SJF order" ) {
+		
+		os.systemConfig.processorScheduling = name;
+	}
+	
+	os.scheduler.config = os.systemConfig;
+	os.scheduler.log.level = LOG_NONE;
+	
+	start = chrono::steady_clock::now();
+	
+	if( !os.readMetaData() ) {
+		
+		return result;
+	}
+	
+	result.seconds = chrono::duration<double>( chrono::steady_clock::now() - start ).count();
+	result.operations = os.scheduler.jobs.ops().size();
+	result.succeeded = true;
+	
+	if( name == "parse" ) {
+		
+		return result;
+	}
+	
+	start = chrono::steady_clock::now();
+	
+	if( name == "SJF order" ) {
+		
+		vector<int> order;
+		
+		for( int handle = 0; handle < os.scheduler.jobs.size(); handle++ ) {
+			
+			order.push_back( handle );
+		}
+		
+		os.sortForSJF( order );
+	}
+	else {
+		
+		os.startJobs();
+		os.simulate();
+		result.events = os.scheduler.events.scheduled();
+	}
+	
+	result.seconds = chrono::duration<double>( chrono::steady_clock::now() - start ).count();
+	
+	return result;
+}
+
+void Benchmark::printRow( string name, long jobs, BenchmarkResult &result ) {
+	
+	double seconds = max( result.seconds, 1e-9 );
+	
+	cout << name << ',' << jobs << ',' << result.operations << ','
+		 << fixed << setprecision( 6 ) << result.seconds << ',' << setprecision( 0 )
+		 << jobs / seconds << ',' << result.events / seconds << ',' << setprecision( 1 )
+		 << ( result.operations == 0 ? 0 : 1e9 * seconds / result.operations ) << ','
+		 << result.peakMemory << endl;
+}
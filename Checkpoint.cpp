@@ -0,0 +1,817 @@
+#include "TraceCache.cpp"
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+// set when the process gets SIGUSR1, a checkpoint is made as soon as the
+// event being handled is done.. kill -USR1 <pid>
+volatile sig_atomic_t checkpointRequested = 0;
+
+void requestCheckpoint( int ) {
+	
+	checkpointRequested = 1;
+}
+
+// the start of a checkpoint file, a checkpoint can only be resumed by a
+// run of the same metadata with the same config
+struct CheckpointHeader {
+	
+	char magic[ 8 ];	// OSCKPT & two 0s
+	int version;
+	int processors;
+	long jobCount;
+	long sourceSize;	// size & modification time of the metadata the run is of
+	long sourceSeconds;
+	long sourceNanoseconds;
+	char scheduling[ 32 ];	// processor scheduling of the run
+	unsigned long configHash;	// hash of the rest of the config the run depends on
+};
+
+// every checkpoint is a record added on the end of the file, the record
+// is followed by its jobs, the metrics of the jobs that exited since the
+// last record & then everything else the scheduler has
+struct CheckpointRecord {
+	
+	char magic[ 8 ];	// OSCKREC & a 0
+	long length;	// bytes of the record after this
+	long events;	// events handled when the checkpoint was made
+	long logged;	// bytes the log had written
+	long traced;	// bytes the trace had written, -1 if there is no trace
+	long jobCount;	// jobs in the record
+	long metricsCount;	// job metrics in the record
+};
+
+// the checkpoint saves the simulation between two events so it can be
+// resumed later & come out exactly like a run that was never stopped..
+// the file only ever has records added to it, a record has the jobs that
+// were touched since the record before it & the rest of the scheduler
+// whole, which is small next to the jobs.. once the file is twice the
+// size of every job the next record has every job & the file starts over
+// with it.. a record that was cut short by the process dying is ignored
+class Checkpoint {
+	
+	public:
+		
+		static const int VERSION = 6;
+		
+		// constructor & destructor
+		Checkpoint();
+		~Checkpoint();
+		
+		// starts making checkpoints of the scheduler into the file, a new run
+		// starts the file over & a resumed run carries on after the record it
+		// resumed from.. returns false if the file could not be written
+		bool start( string, Scheduler & );
+		
+		// counts the event that was just handled, true if a checkpoint is to
+		// be made now
+		bool due() {
+			
+			if( fout == NULL ) {
+				
+				return false;
+			}
+			
+			handled++;
+			
+			return ( checkpointRequested || ( every > 0 && handled % every == 0 ) );
+		}
+		
+		// adds a record of the scheduler to the file, returns false if it
+		// could not be written
+		bool write( Scheduler & );
+		
+		// reads every whole record of the file, returns false if there is
+		// none or the file is of a different run than the config
+		bool read( string, Configure & );
+		
+		// puts the scheduler back to the last record read, returns false if
+		// the jobs of the scheduler are not the ones the records are of
+		bool restore( Scheduler & );
+		
+		// stops making checkpoints & removes the file, a run that finished
+		// has nothing to resume
+		void finish();
+		
+		bool loaded() {
+			
+			return !records.empty();
+		}
+		
+		long every; // events between checkpoints, 0 only makes them when asked to
+		long logged; // bytes the log had written at the last record read
+		long traced; // bytes the trace had written at the last record read
+	
+	private:
+		
+		// the header a file of the run with the config & number of jobs has
+		CheckpointHeader header( Configure &, long );
+		
+		// hash of every setting of the config that changes how the run
+		// comes out, other than the ones the header has by themselves
+		unsigned long configHash( Configure & );
+		
+		// everything but the jobs, always saved whole
+		void saveState( Scheduler & );
+		bool loadState( Scheduler & );
+		
+		// bytes of a record with every job & job metric in it
+		long fullSize( Scheduler & );
+		
+		// writing to the record being made
+		void put( const void *data, size_t bytes ) {
+			
+			buffer.append( (const char *) data, bytes );
+		}
+		
+		template<class T> void put( const T &value ) {
+			
+			put( &value, sizeof( value ) );
+		}
+		
+		// the size of the container & then every item in it
+		template<class T> void putAll( const T &container ) {
+			
+			put( (long) container.size() );
+			
+			for( auto &item : container ) {
+				
+				put( item );
+			}
+		}
+		
+		// queues can not be gone through, so a copy of it is emptied
+		void putQueue( queue<int> items ) {
+			
+			put( (long) items.size() );
+			
+			for( ; !items.empty(); items.pop() ) {
+				
+				put( items.front() );
+			}
+		}
+		
+		// reading from the record being restored, every read fails once one
+		// has run past the end of the record
+		bool get( void *data, size_t bytes ) {
+			
+			if( at == NULL || (size_t) ( end - at ) < bytes ) {
+				
+				at = NULL;
+				return false;
+			}
+			
+			memcpy( data, at, bytes );
+			at += bytes;
+			
+			return true;
+		}
+		
+		template<class T> bool get( T &value ) {
+			
+			return get( &value, sizeof( value ) );
+		}
+		
+		template<class T> bool getAll( T &container ) {
+			
+			long count = 0;
+			
+			if( !get( count ) || count < 0 || count > end - at ) {
+				
+				at = NULL;
+				return false;
+			}
+			
+			container.resize( count );
+			
+			for( auto &item : container ) {
+				
+				get( item );
+			}
+			
+			return ( at != NULL );
+		}
+		
+		bool getQueue( queue<int> &items ) {
+			
+			vector<int> all;
+			
+			items = queue<int>();
+			
+			if( !getAll( all ) ) {
+				
+				return false;
+			}
+			
+			for( int i = 0; i < (int) all.size(); i++ ) {
+				
+				items.push( all[ i ] );
+			}
+			
+			return true;
+		}
+		
+		string filename;
+		FILE *fout; // the file while checkpoints are made, NULL otherwise
+		long fileSize; // bytes in the file
+		long handled; // events handled by the run, counting the ones before it was resumed
+		long savedMetrics; // job metrics already in the file
+		
+		string buffer; // the record being made
+		
+		string contents; // the file as it was read
+		vector<long> records; // where every whole record read starts
+		long validEnd; // end of the last whole record
+		const char *at; // where the record being restored is read from next, NULL once a read failed
+		const char *end;
+};
+
+Checkpoint::Checkpoint() {
+	
+	every = 0;
+	logged = -1;
+	traced = -1;
+	fout = NULL;
+	fileSize = 0;
+	handled = 0;
+	savedMetrics = 0;
+	validEnd = 0;
+	at = NULL;
+	end = NULL;
+}
+
+Checkpoint::~Checkpoint() {
+	
+	if( fout != NULL ) {
+		
+		fclose( fout );
+	}
+}
+
+CheckpointHeader Checkpoint::header( Configure &config, long jobCount ) {
+	
+	CheckpointHeader header;
+	struct stat info;
+	
+	memset( &header, 0, sizeof( header ) );
+	memcpy( header.magic, "OSCKPT", 6 );
+	header.version = VERSION;
+	header.processors = config.processors;
+	header.jobCount = jobCount;
+	header.configHash = configHash( config );
+	strncpy( header.scheduling, config.processorScheduling.c_str(), sizeof( header.scheduling ) - 1 );
+	
+	if( stat( config.file.c_str(), &info ) == 0 ) {
+		
+		header.sourceSize = info.st_size;
+		header.sourceSeconds = info.st_mtim.tv_sec;
+		header.sourceNanoseconds = info.st_mtim.tv_nsec;
+	}
+	
+	return header;
+}
+
+// the settings are written out one after another & the text is hashed
+// with FNV-1a, a different quantum, device, memory or MLFQ setting gives
+// a different hash
+unsigned long Checkpoint::configHash( Configure &config ) {
+	
+	string settings = to_string( config.quantom ) + "," + to_string( config.affinity ) + "," + to_string( config.streamWindow );
+	unsigned long hash = 14695981039346656037UL;
+	
+	// the cycle time of a device is what one cycle of it costs
+	for( int device = 0; device < config.devices.size(); device++ ) {
+		
+		settings += "," + config.devices.name( device ) + ":" + to_string( config.devices.cost( device, 1 ) )
+					+ ":" + to_string( config.devices.channelCount( device ) );
+	}
+	
+	settings += "," + config.memoryType + ":" + to_string( config.memorySize ) + ":" + to_string( config.memoryPartitions )
+				+ ":" + to_string( config.pageSize ) + ":" + to_string( config.memoryFrames );
+	
+	settings += ",MLFQ:" + to_string( config.mlfqLevels ) + ":" + to_string( config.mlfqBoost );
+	
+	for( int i = 0; i < (int) config.mlfqQuanta.size(); i++ ) {
+		
+		settings += ":" + to_string( config.mlfqQuanta[ i ] );
+	}
+	
+	for( int i = 0; i < (int) settings.size(); i++ ) {
+		
+		hash = ( hash ^ (unsigned char) settings[ i ] ) * 1099511628211UL;
+	}
+	
+	return hash;
+}
+
+bool Checkpoint::start( string checkpointFile, Scheduler &scheduler ) {
+	
+	Configure &config = scheduler.config;
+	
+	filename = checkpointFile;
+	savedMetrics = scheduler.metrics.jobs.size();
+	
+	// a resumed run cuts off anything after the record it resumed from,
+	// a new run starts with only the header
+	if( loaded() ) {
+		
+		fout = fopen( filename.c_str(), "r+b" );
+		
+		if( fout != NULL && ( ftruncate( fileno( fout ), validEnd ) == -1 || fseek( fout, validEnd, SEEK_SET ) != 0 ) ) {
+			
+			fclose( fout );
+			fout = NULL;
+		}
+		
+		fileSize = validEnd;
+	}
+	else {
+		
+		CheckpointHeader fileHeader = header( config, scheduler.jobs.size() );
+		
+		fout = fopen( filename.c_str(), "wb" );
+		
+		if( fout != NULL && ( fwrite( &fileHeader, sizeof( fileHeader ), 1, fout ) != 1 || fflush( fout ) != 0 ) ) {
+			
+			fclose( fout );
+			fout = NULL;
+		}
+		
+		fileSize = sizeof( fileHeader );
+	}
+	
+	if( fout == NULL ) {
+		
+		return false;
+	}
+	
+	// only the jobs touched from here on are saved with the next record,
+	// the rest are still as they are in the metadata or the records before
+	scheduler.jobs.track( true );
+	
+	return true;
+}
+
+long Checkpoint::fullSize( Scheduler &scheduler ) {
+	
+	return ( sizeof( CheckpointHeader ) + sizeof( CheckpointRecord ) + scheduler.jobs.size() * ( sizeof( int ) + sizeof( Job ) )
+			 + scheduler.metrics.jobs.size() * sizeof( JobMetrics ) );
+}
+
+bool Checkpoint::write( Scheduler &scheduler ) {
+	
+	JobTable &jobs = scheduler.jobs;
+	vector<JobMetrics> &metrics = scheduler.metrics.jobs;
+	CheckpointRecord record;
+	
+	checkpointRequested = 0;
+	
+	// whatever was logged before the checkpoint has to be in the log file,
+	// a resumed run cuts the log back to here
+	scheduler.log.flush();
+	
+	if( scheduler.trace.enabled() && !scheduler.trace.flush() ) {
+		
+		return false;
+	}
+	
+	// once the records add up to more than twice every job the file starts
+	// over with one record of everything
+	bool whole = ( fileSize > 2 * fullSize( scheduler ) );
+	
+	memset( &record, 0, sizeof( record ) );
+	memcpy( record.magic, "OSCKREC", 7 );
+	record.events = handled;
+	record.logged = scheduler.log.logged();
+	record.traced = ( scheduler.trace.enabled() ? scheduler.trace.traced() : -1 );
+	record.jobCount = ( whole ? jobs.size() : jobs.touchedJobs.size() );
+	record.metricsCount = metrics.size() - ( whole ? 0 : savedMetrics );
+	
+	buffer.clear();
+	put( record );
+	
+	for( int i = 0; i < record.jobCount; i++ ) {
+		
+		int handle = ( whole ? i : jobs.touchedJobs[ i ] );
+		
+		put( handle );
+		put( jobs.jobs[ handle ] );
+	}
+	
+	for( int i = metrics.size() - record.metricsCount; i < (int) metrics.size(); i++ ) {
+		
+		put( metrics[ i ] );
+	}
+	
+	saveState( scheduler );
+	
+	record.length = buffer.size() - sizeof( record );
+	memcpy( &buffer[ 0 ], &record, sizeof( record ) );
+	
+	// the whole file is written next to the old one & only takes its place
+	// once it is all there, so there is always a file to resume from
+	if( whole ) {
+		
+		CheckpointHeader fileHeader = header( scheduler.config, jobs.size() );
+		string temporary = filename + ".tmp";
+		FILE *file = fopen( temporary.c_str(), "wb" );
+		
+		if( file == NULL ) {
+			
+			return false;
+		}
+		
+		bool written = ( fwrite( &fileHeader, sizeof( fileHeader ), 1, file ) == 1
+						 && fwrite( buffer.data(), 1, buffer.size(), file ) == buffer.size() );
+		
+		if( fclose( file ) != 0 || !written || rename( temporary.c_str(), filename.c_str() ) != 0 ) {
+			
+			unlink( temporary.c_str() );
+			return false;
+		}
+		
+		fclose( fout );
+		fout = fopen( filename.c_str(), "ab" );
+		fileSize = sizeof( fileHeader );
+	}
+	
+	if( fout == NULL || ( !whole && fwrite( buffer.data(), 1, buffer.size(), fout ) != buffer.size() ) || fflush( fout ) != 0 ) {
+		
+		return false;
+	}
+	
+	fileSize += buffer.size();
+	savedMetrics = metrics.size();
+	
+	// the jobs start out untouched again for the next record
+	jobs.track( true );
+	
+	return true;
+}
+
+void Checkpoint::saveState( Scheduler &scheduler ) {
+	
+	put( scheduler.clock );
+	put( scheduler.migrations );
+	put( scheduler.steals );
+	put( scheduler.readyJobs );
+	put( scheduler.nextCore );
+	put( scheduler.jobsDone );
+	put( scheduler.turnaroundTime );
+	put( scheduler.waitingTime );
+	put( scheduler.liveJobs );
+	put( scheduler.lastPID );
+	
+	put( (long) scheduler.cores.size() );
+	
+	for( int i = 0; i < (int) scheduler.cores.size(); i++ ) {
+		
+		Core &core = scheduler.cores[ i ];
+		
+		put( core.currentJob );
+		put( core.lastJob );
+		put( core.cpuBusy );
+		put( core.busyTime );
+		put( core.slices );
+		put( core.sliceStart );
+		put( core.sliceEnd );
+		put( core.sliceCycles );
+		put( core.sliceEvent );
+		putAll( core.readyQueue );
+	}
+	
+	// the heaps are saved as they are laid out, so they come back exactly
+	// the same & give out their jobs in the same order
+	putAll( scheduler.events.events );
+	put( scheduler.events.nextSequence );
+	
+	putAll( scheduler.readyHeap.heap );
+	put( scheduler.readyHeap.nextOrder );
+	
+	put( (long) scheduler.levelQueues.size() );
+	
+	for( int i = 0; i < (int) scheduler.levelQueues.size(); i++ ) {
+		
+		putAll( scheduler.levelQueues[ i ] );
+	}
+	
+	put( scheduler.levelBits );
+	put( scheduler.boosts );
+	put( scheduler.nextBoost );
+	put( scheduler.demotions );
+	put( scheduler.promotions );
+	
+	put( (long) scheduler.waitQueues.size() );
+	
+	for( int i = 0; i < (int) scheduler.waitQueues.size(); i++ ) {
+		
+		putQueue( scheduler.waitQueues[ i ] );
+	}
+	
+	putAll( scheduler.busyChannels );
+	putAll( scheduler.deviceTime );
+	
+	put( (long) scheduler.trace.channelEnds.size() );
+	
+	for( int i = 0; i < (int) scheduler.trace.channelEnds.size(); i++ ) {
+		
+		putAll( scheduler.trace.channelEnds[ i ] );
+	}
+	
+	MemoryManager &memory = scheduler.memory;
+	
+	put( memory.inUse );
+	put( memory.peakInUse );
+	put( memory.allocations );
+	put( memory.failures );
+	put( memory.fragmentedFailures );
+	put( memory.requested );
+	put( memory.given );
+	putAll( memory.freePartitions );
+	putAll( memory.freeBlocks );
+	putAll( memory.freeHead );
+	put( memory.freeOrders );
+	put( memory.freeFrames );
+	
+	putQueue( scheduler.swapQueue );
+	put( scheduler.swapOuts );
+	put( scheduler.swappedTime );
+	put( scheduler.peakSwapped );
+	put( scheduler.rejectedJobs );
+	put( scheduler.memoryReleased );
+	
+	// a histogram is the same size however many values are in it
+	put( scheduler.metrics.turnaround );
+	put( scheduler.metrics.waiting );
+	put( scheduler.metrics.response );
+	put( scheduler.metrics.slices );
+	put( scheduler.metrics.ios );
+}
+
+bool Checkpoint::read( string checkpointFile, Configure &config ) {
+	
+	FILE *fin = fopen( checkpointFile.c_str(), "rb" );
+	CheckpointHeader expected = header( config, 0 );
+	CheckpointHeader found;
+	
+	filename = checkpointFile;
+	records.clear();
+	contents.clear();
+	
+	if( fin == NULL ) {
+		
+		return false;
+	}
+	
+	char chunk[ 1 << 16 ];
+	size_t bytes;
+	
+	while( ( bytes = fread( chunk, 1, sizeof( chunk ), fin ) ) > 0 ) {
+		
+		contents.append( chunk, bytes );
+	}
+	
+	fclose( fin );
+	
+	if( contents.size() < sizeof( found ) ) {
+		
+		return false;
+	}
+	
+	memcpy( &found, contents.data(), sizeof( found ) );
+	
+	// the job count is only known once the metadata is read, restore checks it
+	if( memcmp( found.magic, expected.magic, sizeof( found.magic ) ) != 0 || found.version != VERSION
+		|| found.processors != expected.processors || found.configHash != expected.configHash
+		|| found.sourceSize != expected.sourceSize || found.sourceSeconds != expected.sourceSeconds
+		|| found.sourceNanoseconds != expected.sourceNanoseconds
+		|| strncmp( found.scheduling, expected.scheduling, sizeof( found.scheduling ) ) != 0 ) {
+		
+		return false;
+	}
+	
+	validEnd = sizeof( found );
+	
+	// the records are found one after another until one is not whole
+	while( validEnd + (long) sizeof( CheckpointRecord ) <= (long) contents.size() ) {
+		
+		CheckpointRecord record;
+		
+		memcpy( &record, contents.data() + validEnd, sizeof( record ) );
+		
+		if( memcmp( record.magic, "OSCKREC", 8 ) != 0 || record.length < 0
+			|| record.length > (long) contents.size() - validEnd - (long) sizeof( record ) ) {
+			
+			break;
+		}
+		
+		records.push_back( validEnd );
+		logged = record.logged;
+		traced = record.traced;
+		validEnd += sizeof( record ) + record.length;
+	}
+	
+	return loaded();
+}
+
+bool Checkpoint::restore( Scheduler &scheduler ) {
+	
+	CheckpointHeader found;
+	
+	memcpy( &found, contents.data(), sizeof( found ) );
+	
+	if( found.jobCount != scheduler.jobs.size() ) {
+		
+		return false;
+	}
+	
+	// every record has the jobs that changed since the one before it, so
+	// they are put back oldest first & the rest of the scheduler is only
+	// taken from the last one
+	for( int i = 0; i < (int) records.size(); i++ ) {
+		
+		CheckpointRecord record;
+		
+		memcpy( &record, contents.data() + records[ i ], sizeof( record ) );
+		
+		at = contents.data() + records[ i ] + sizeof( record );
+		end = at + record.length;
+		
+		for( long j = 0; j < record.jobCount; j++ ) {
+			
+			int handle = -1;
+			Job job;
+			
+			if( !get( handle ) || !get( job ) || handle < 0 || handle >= scheduler.jobs.size() ) {
+				
+				return false;
+			}
+			
+			scheduler.jobs.jobs[ handle ] = job;
+		}
+		
+		for( long j = 0; j < record.metricsCount; j++ ) {
+			
+			JobMetrics metrics;
+			
+			if( !get( metrics ) ) {
+				
+				return false;
+			}
+			
+			scheduler.metrics.jobs.push_back( metrics );
+		}
+		
+		handled = record.events;
+	}
+	
+	bool restored = loadState( scheduler );
+	
+	// the file is only needed again to carry on adding to it
+	contents.clear();
+	contents.shrink_to_fit();
+	
+	return restored;
+}
+
+bool Checkpoint::loadState( Scheduler &scheduler ) {
+	
+	long count = 0;
+	
+	get( scheduler.clock );
+	get( scheduler.migrations );
+	get( scheduler.steals );
+	get( scheduler.readyJobs );
+	get( scheduler.nextCore );
+	get( scheduler.jobsDone );
+	get( scheduler.turnaroundTime );
+	get( scheduler.waitingTime );
+	get( scheduler.liveJobs );
+	get( scheduler.lastPID );
+	
+	if( !get( count ) || count != (long) scheduler.cores.size() ) {
+		
+		return false;
+	}
+	
+	for( int i = 0; i < (int) scheduler.cores.size(); i++ ) {
+		
+		Core &core = scheduler.cores[ i ];
+		
+		get( core.currentJob );
+		get( core.lastJob );
+		get( core.cpuBusy );
+		get( core.busyTime );
+		get( core.slices );
+		get( core.sliceStart );
+		get( core.sliceEnd );
+		get( core.sliceCycles );
+		get( core.sliceEvent );
+		getAll( core.readyQueue );
+	}
+	
+	getAll( scheduler.events.events );
+	get( scheduler.events.nextSequence );
+	
+	getAll( scheduler.readyHeap.heap );
+	get( scheduler.readyHeap.nextOrder );
+	
+	if( !get( count ) || count != (long) scheduler.levelQueues.size() ) {
+		
+		return false;
+	}
+	
+	for( int i = 0; i < (int) scheduler.levelQueues.size(); i++ ) {
+		
+		getAll( scheduler.levelQueues[ i ] );
+	}
+	
+	get( scheduler.levelBits );
+	get( scheduler.boosts );
+	get( scheduler.nextBoost );
+	get( scheduler.demotions );
+	get( scheduler.promotions );
+	
+	if( !get( count ) || count != (long) scheduler.waitQueues.size() ) {
+		
+		return false;
+	}
+	
+	for( int i = 0; i < (int) scheduler.waitQueues.size(); i++ ) {
+		
+		getQueue( scheduler.waitQueues[ i ] );
+	}
+	
+	getAll( scheduler.busyChannels );
+	getAll( scheduler.deviceTime );
+	
+	// the channels only go back if the resumed run has a trace as well
+	if( !get( count ) || count < 0 || count > end - at ) {
+		
+		return false;
+	}
+	
+	vector< vector<long> > channelEnds( count );
+	
+	for( int i = 0; i < count; i++ ) {
+		
+		getAll( channelEnds[ i ] );
+	}
+	
+	if( channelEnds.size() == scheduler.trace.channelEnds.size() ) {
+		
+		scheduler.trace.channelEnds = channelEnds;
+	}
+	
+	MemoryManager &memory = scheduler.memory;
+	
+	// the free buddy blocks are saved in whatever order the map had them,
+	// they are only ever looked up by where they start
+	vector< pair<long, MemoryManager::FreeBlock> > freeBlocks;
+	
+	get( memory.inUse );
+	get( memory.peakInUse );
+	get( memory.allocations );
+	get( memory.failures );
+	get( memory.fragmentedFailures );
+	get( memory.requested );
+	get( memory.given );
+	getAll( memory.freePartitions );
+	getAll( freeBlocks );
+	memory.freeBlocks = unordered_map<long, MemoryManager::FreeBlock>( freeBlocks.begin(), freeBlocks.end() );
+	getAll( memory.freeHead );
+	get( memory.freeOrders );
+	get( memory.freeFrames );
+	
+	getQueue( scheduler.swapQueue );
+	get( scheduler.swapOuts );
+	get( scheduler.swappedTime );
+	get( scheduler.peakSwapped );
+	get( scheduler.rejectedJobs );
+	get( scheduler.memoryReleased );
+	
+	get( scheduler.metrics.turnaround );
+	get( scheduler.metrics.waiting );
+	get( scheduler.metrics.response );
+	get( scheduler.metrics.slices );
+	get( scheduler.metrics.ios );
+	
+	// anything left over means the record was not made by this version
+	return ( at != NULL && at == end );
+}
+
+void Checkpoint::finish() {
+	
+	if( fout != NULL ) {
+		
+		fclose( fout );
+		fout = NULL;
+		unlink( filename.c_str() );
+	}
+}
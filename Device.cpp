@@ -0,0 +1,124 @@
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+// the device table interns every instruction name ( run, hard drive,
+// keyboard, etc ) into a small integer id when the metadata is read in,
+// so operations carry an id instead of a string.. the cycle time of each
+// device is kept in an array indexed by that id, which makes costing an
+// operation a single lookup & multiply instead of a chain of string compares
+class DeviceTable {
+	
+	public:
+		
+		// ids of the devices every system has, anything registered from
+		// the config file gets the next id after these
+		enum {
+			RUN,
+			HARD_DRIVE,
+			KEYBOARD,
+			MONITOR,
+			PRINTER,
+			BUILT_IN_DEVICES
+		};
+		
+		// constructor
+		DeviceTable();
+		
+		// adds a device or updates the cycle time of an existing one,
+		// returns the id of the device
+		int registerDevice( string, int );
+		
+		// returns the id of the device or -1 if it was never registered
+		int lookup( string_view );
+		
+		// sets the cycle time ( msec ) of a device
+		void setCycleTime( int device, int cycleTime ) {
+			
+			cycleTimes[ device ] = cycleTime;
+		}
+		
+		// sets how many operations the device can work on at once
+		void setChannels( int device, int count ) {
+			
+			channels[ device ] = count;
+		}
+		
+		// number of operations the device can work on at once
+		int channelCount( int device ) {
+			
+			return channels[ device ];
+		}
+		
+		// time it takes the device to get through the given cycles
+		long cost( int device, long cycles ) {
+			
+			return ( cycles * cycleTimes[ device ] );
+		}
+		
+		// name of the device, used for printing
+		string &name( int device ) {
+			
+			return names[ device ];
+		}
+		
+		// number of devices registered
+		int size() {
+			
+			return names.size();
+		}
+	
+	private:
+		
+		vector<string> names;	// name of each device, indexed by id
+		vector<int> cycleTimes;	// cycle time ( msec ) of each device, indexed by id
+		vector<int> channels;	// operations each device can do at once, indexed by id
+};
+
+DeviceTable::DeviceTable() {
+	
+	// these must be registered in the same order as the enum
+	registerDevice( "run", 0 );
+	registerDevice( "hard drive", 0 );
+	registerDevice( "keyboard", 0 );
+	registerDevice( "monitor", 0 );
+	registerDevice( "printer", 0 );
+}
+
+int DeviceTable::registerDevice( string deviceName, int cycleTime ) {
+	
+	int device = lookup( deviceName );
+	
+	// if the device already exists just update its cycle time
+	if( device != -1 ) {
+		
+		cycleTimes[ device ] = cycleTime;
+		return device;
+	}
+	
+	names.push_back( deviceName );
+	cycleTimes.push_back( cycleTime );
+	
+	// every device starts off doing one operation at a time
+	channels.push_back( 1 );
+	
+	return ( names.size() - 1 );
+}
+
+// there are only ever a handful of devices so a linear scan is faster
+// than hashing the name, this only runs while the metadata is read in
+int DeviceTable::lookup( string_view deviceName ) {
+	
+	for( int i = 0; i < (int) names.size(); i++ ) {
+		
+		if( names[ i ] == deviceName ) {
+			
+			return i;
+		}
+	}
+	
+	return -1;
+}
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+// the kinds of things that can happen in the simulation
+enum EventType {
+	
+	JOB_ARRIVAL,	// a job enters the system
+	SLICE_END,		// the cpu finished running a job for a while
+	IO_COMPLETE		// a device finished the io operation of a job
+};
+
+// an event is something that happens at a point in simulated time
+struct Event {
+	
+	long time;		// simulated time ( msec ) the event happens at
+	long sequence;	// order the event was scheduled in, breaks ties in time
+	int type;		// one of the event types
+	int handle;		// the job the event belongs to
+	int cycles;		// cycles of the operation that were done by the event
+};
+
+// the event queue always gives back the earliest event, events that
+// happen at the same time come out in the order they were scheduled so
+// every run of the simulation comes out the same
+class EventQueue {
+	
+	public:
+		
+		// constructor
+		EventQueue() {
+			
+			nextSequence = 0;
+		}
+		
+		// adds an event that happens at the given time, returns the 
+		// sequence of the event so it can be told apart later
+		long schedule( long time, int type, int handle, int cycles ) {
+			
+			Event event;
+			
+			event.time = time;
+			event.sequence = nextSequence++;
+			event.type = type;
+			event.handle = handle;
+			event.cycles = cycles;
+			
+			events.push_back( event );
+			push_heap( events.begin(), events.end(), Later() );
+			
+			return event.sequence;
+		}
+		
+		// takes the earliest event off the queue
+		Event next() {
+			
+			pop_heap( events.begin(), events.end(), Later() );
+			
+			Event event = events.back();
+			events.pop_back();
+			
+			return event;
+		}
+		
+		// time of the earliest event
+		long nextTime() {
+			
+			return events.front().time;
+		}
+		
+		bool empty() {
+			
+			return events.empty();
+		}
+		
+		int size() {
+			
+			return events.size();
+		}
+		
+		// number of events ever scheduled, every one of them is taken off
+		// the queue by the end of the simulation
+		long scheduled() {
+			
+			return nextSequence;
+		}
+	
+	private:
+		
+		// the checkpoint saves & restores the events as they are
+		friend class Checkpoint;
+		
+		// orders the heap so the earliest event is on top
+		struct Later {
+			
+			bool operator()( const Event &a, const Event &b ) const {
+				
+				if( a.time != b.time ) {
+					
+					return ( a.time > b.time );
+				}
+				
+				return ( a.sequence > b.sequence );
+			}
+		};
+		
+		vector<Event> events; // a heap ordered by Later, the earliest event is at the front
+		
+		long nextSequence;
+};
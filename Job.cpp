@@ -1,4 +1,8 @@
+#include "Device.cpp"
 #include <iostream>
+#include <deque>
+#include <vector>
+#include <algorithm>
 
 using namespace std;
 
@@ -6,14 +10,153 @@ using namespace std;
 struct Operation {
 	
 	char type;	// the type of operation it is, can be P for process I for input O for output
-	string instruction;	// instruction type can be run, keyboard, monitor, hard drive etc.
+	int device;	// id of the instruction type in the device table, can be run, keyboard, monitor, hard drive etc.
 	int cycleTime;	// amount of time it takes to complete
 };
 
+// the operation table holds the operations of every job back to back, each
+// field of an operation is kept in its own array so a scan over one field
+// ( like the types when looking for I/O ) only touches that field.. the
+// operations never change once they are read in, the progress of a job
+// is kept in the job itself.. the table reads its operations through
+// pointers to the arrays so it can also read arrays it does not own, like
+// the ones in a mapped trace cache
+class OperationTable {
+	
+	public:
+		
+		// constructor
+		OperationTable() {
+			
+			viewing = false;
+			refresh();
+		}
+		
+		// a copy reads its own arrays, unless the other table was viewing
+		OperationTable( const OperationTable &other ) {
+			
+			*this = other;
+		}
+		
+		OperationTable &operator=( const OperationTable &other ) {
+			
+			types = other.types;
+			devices = other.devices;
+			cycleTimes = other.cycleTimes;
+			viewing = other.viewing;
+			
+			if( viewing ) {
+				
+				view( other.typeAt, other.deviceAt, other.cycleAt, other.count );
+			}
+			else {
+				
+				refresh();
+			}
+			
+			return *this;
+		}
+		
+		// adds an operation to the end of the table & returns its index
+		int add( Operation &op ) {
+			
+			types.push_back( op.type );
+			devices.push_back( op.device );
+			cycleTimes.push_back( op.cycleTime );
+			
+			// the arrays might have moved
+			refresh();
+			
+			return ( count - 1 );
+		}
+		
+		// returns the operation at the index as a single value
+		Operation get( int index ) {
+			
+			Operation op;
+			
+			op.type = typeAt[ index ];
+			op.device = deviceAt[ index ];
+			op.cycleTime = cycleAt[ index ];
+			
+			return op;
+		}
+		
+		// type, device & cycles of the operation at the index
+		char type( int index ) {
+			
+			return typeAt[ index ];
+		}
+		
+		int device( int index ) {
+			
+			return deviceAt[ index ];
+		}
+		
+		int cycles( int index ) {
+			
+			return cycleAt[ index ];
+		}
+		
+		// number of operations in the table
+		int size() {
+			
+			return count;
+		}
+		
+		// reads the given arrays instead of the tables own, nothing is
+		// copied so the arrays have to stay while the table is used
+		void view( const char *viewTypes, const int *viewDevices, const int *viewCycles, int viewCount ) {
+			
+			typeAt = viewTypes;
+			deviceAt = viewDevices;
+			cycleAt = viewCycles;
+			count = viewCount;
+			viewing = true;
+		}
+		
+		// reads the tables own arrays again, has to be called after the
+		// arrays are changed directly
+		void refresh() {
+			
+			typeAt = types.data();
+			deviceAt = devices.data();
+			cycleAt = cycleTimes.data();
+			count = types.size();
+			viewing = false;
+		}
+		
+		vector<char> types;		// P, I or O for every operation
+		vector<int> devices;	// device id for every operation
+		vector<int> cycleTimes;	// cycles every operation needs to complete
+	
+	private:
+		
+		// the arrays the operations are read from & how many there are
+		const char *typeAt;
+		const int *deviceAt;
+		const int *cycleAt;
+		int count;
+		
+		bool viewing; // true if the arrays are not the tables own
+};
+
+// what a job is waiting on before it can go on, a job is always stopped
+// at one of these between events & the scheduler keeps it in the ready
+// queues, the wait queue of a device or lets it exit to match
+enum JobWait {
+	
+	WAIT_CPU,	// the operation it is on runs on a core
+	WAIT_IO,	// the operation it is on is done by a device
+	WAIT_EXIT	// it has done every operation
+};
+
 // a job represents "A" from start to end in the meta data
 // every process, input or output operations that happen from 
 // the beginning to the end make up the job, once all operations 
-// have been completed the job is completed & taked off the ready queue
+// have been completed the job is completed & taked off the ready queue..
+// the operations of the job live in the operation table, the job only 
+// knows where its operations start & how many there are
 class Job {
 	
 	public:
@@ -22,7 +165,18 @@ class Job {
 		Job() {
 			// intialiaze 
 			timeToProcessJob = 0;
+			firstOperation = 0;
+			numberOfOperations = 0;
 			currentOperation = 0;
+			remainingCycles = 0;
+			core = -1;
+			arrivalTime = 0;
+			startTime = -1;
+			remainingTime = 0;
+			memory = 0;
+			memoryBlock = -1;
+			level = 0;
+			levelBoost = 0;
 		}
 		
 		// returns if the job is finished
@@ -34,18 +188,355 @@ class Job {
 		// returns if the current operation is finished
 		bool operationFinished() {
 			
-			return ( processes[ currentOperation ].cycleTime == 0 );
+			return ( remainingCycles == 0 );
 		}
 	
 		int PID;	// PID of the job
 		
-		int timeToProcessJob;	// time it takes to process the job,
+		long timeToProcessJob;	// time it takes to process the job,
 								// this is used to sort for shortest job first
 								
+		int firstOperation;	// index of the first operation of this job in the operation table
+		
 		int numberOfOperations; // number of operations that make up this job
 								// all operations must be complete for job to be done
 								
-		int currentOperation;	// the current operation in action can be process or I/O
+		int currentOperation;	// the current operation in action can be process or I/O,
+							// counted from the first operation of the job
+		
+		int remainingCycles;	// cycles left on the current operation
+		
+		int core;	// core the job last ran on, -1 if it has not run yet
+		
+		long arrivalTime;	// simulated time ( msec ) the job entered the system
 		
-		Operation processes[ 256 ];	// all operations that make up the job 
+		long startTime;	// simulated time ( msec ) the job first got a core or device, -1 until then
+		
+		long remainingTime;	// time ( msec ) of the work the job has left, starts at the
+							// time to process the job & goes down as cycles are done
+		
+		long memory;	// memory ( KB ) the job needs to be in the system, 0 if it needs none
+		
+		long memoryBlock;	// where the memory manager put the job, -1 if it has no memory
+		
+		int level;	// MLFQ level of the job, 0 is the highest
+		
+		long levelBoost;	// boosts there had been when the level was set, the level
+							// is back to 0 once there has been another one
 };
+
+// the job table is the arena that owns every job in the simulation, jobs
+// are created in it once & never copied again.. the scheduler's queues only
+// hold handles ( the index of the job in the table ) so moving a job between
+// the ready & wait queue or swapping the current job is just an int copy
+class JobTable {
+	
+	public:
+	
+		// constructor
+		JobTable();
+		
+		// creates a new job at the end of the table & returns its handle
+		int createJob();
+		
+		// adds an operation to the end of the job, operations have to be 
+		// added to the job that was created last
+		void addOperation( int, Operation & );
+		
+		// moves the job on to its next operation
+		void nextOperation( Job & );
+		
+		// moves every job & operation of another table onto the end of 
+		// this one, returns the handle the first of them ends up with
+		int append( JobTable & );
+		
+		// copies one job & its operations from another table into this
+		// one, returns the handle the job has in this table
+		int adopt( JobTable &, int );
+		
+		// gives the job's slot & operations back once it has left the
+		// system, the handle can be handed out again by createJob
+		void releaseJob( int );
+		
+		// removes every job & operation but keeps the memory
+		void clear();
+		
+		// copies the jobs of another table but not its operations, the
+		// operations are read from the other table instead.. the other 
+		// table must not change or go away while this one is used
+		void share( JobTable & );
+		
+		// works out the time to process every job again with the cycle
+		// times of the given devices
+		void recost( DeviceTable & );
+		
+		// returns the job that belongs to the handle, while tracking the job
+		// is marked as touched since it might be changed
+		Job &operator[]( int handle ) {
+			
+			if( tracking && !touched[ handle ] ) {
+				
+				touched[ handle ] = true;
+				touchedJobs.push_back( handle );
+			}
+			
+			return jobs[ handle ];
+		}
+		
+		// starts or stops marking the jobs that are handed out, every job
+		// starts out untouched
+		void track( bool );
+		
+		bool tracking; // jobs handed out are marked as touched
+		vector<int> touchedJobs; // handles of the jobs touched since tracking started or they were last cleared
+		
+		// type, device & original cycles of the operation the job is on
+		char type( Job &job ) {
+			
+			return ops().type( job.firstOperation + job.currentOperation );
+		}
+		
+		int device( Job &job ) {
+			
+			return ops().device( job.firstOperation + job.currentOperation );
+		}
+		
+		int cycles( Job &job ) {
+			
+			return ops().cycles( job.firstOperation + job.currentOperation );
+		}
+		
+		// number of jobs in the table
+		int size() {
+			
+			return jobs.size();
+		}
+		
+		OperationTable operations;	// operations of every job in the table
+		
+		// the operations the jobs point into, either the tables own or the
+		// ones of the table it shares with
+		OperationTable &ops() {
+			
+			return ( shared != NULL ? *shared : operations );
+		}
+		
+	private:
+		
+		// the checkpoint reads the jobs without touching them
+		friend class Checkpoint;
+		
+		// moves the operations of the jobs still in the table together
+		void compact();
+		
+		// deque so references to jobs stay valid as the table grows
+		deque<Job> jobs;
+		
+		vector<int> freeHandles;	// slots of released jobs that can be reused
+		int deadOperations;	// operations of released jobs still in the operation table
+		
+		OperationTable *shared;	// operations of another table, NULL if the table has its own
+		
+		vector<bool> touched; // the job is in the touched jobs
+};
+
+JobTable::JobTable() {
+	
+	deadOperations = 0;
+	shared = NULL;
+	tracking = false;
+}
+
+int JobTable::createJob() {
+	
+	int handle;
+	
+	// reuse the slot of a job that already left if there is one
+	if( !freeHandles.empty() ) {
+		
+		handle = freeHandles.back();
+		freeHandles.pop_back();
+		jobs[ handle ] = Job();
+	}
+	else {
+		
+		handle = jobs.size();
+		jobs.emplace_back();
+	}
+	
+	// the operations of this job will start at the end of the table
+	jobs[ handle ].firstOperation = operations.size();
+	
+	return handle;
+}
+
+void JobTable::addOperation( int handle, Operation &op ) {
+	
+	Job &job = jobs[ handle ];
+	
+	operations.add( op );
+	
+	// the first operation is the one the job starts on
+	if( job.numberOfOperations == 0 ) {
+		
+		job.remainingCycles = op.cycleTime;
+	}
+	
+	job.numberOfOperations++;
+}
+
+void JobTable::nextOperation( Job &job ) {
+	
+	job.currentOperation++;
+	
+	if( !job.jobFinished() ) {
+		
+		job.remainingCycles = cycles( job );
+	}
+}
+
+int JobTable::append( JobTable &other ) {
+	
+	int firstHandle = jobs.size();
+	int base = operations.size();
+	
+	operations.types.insert( operations.types.end(), other.operations.types.begin(), other.operations.types.end() );
+	operations.devices.insert( operations.devices.end(), other.operations.devices.begin(), other.operations.devices.end() );
+	operations.cycleTimes.insert( operations.cycleTimes.end(), other.operations.cycleTimes.begin(), other.operations.cycleTimes.end() );
+	operations.refresh();
+	
+	// the operations moved over by base, so the jobs have to point further in
+	for( int i = 0; i < other.size(); i++ ) {
+		
+		jobs.push_back( other[ i ] );
+		jobs.back().firstOperation += base;
+	}
+	
+	return firstHandle;
+}
+
+int JobTable::adopt( JobTable &other, int handle ) {
+	
+	int newHandle = createJob();
+	Job &job = jobs[ newHandle ];
+	
+	job = other[ handle ];
+	job.firstOperation = operations.size();
+	
+	for( int i = 0; i < job.numberOfOperations; i++ ) {
+		
+		Operation op = other.ops().get( other[ handle ].firstOperation + i );
+		operations.add( op );
+	}
+	
+	return newHandle;
+}
+
+void JobTable::releaseJob( int handle ) {
+	
+	deadOperations += jobs[ handle ].numberOfOperations;
+	
+	// a released job has no operations, so compacting skips over it
+	jobs[ handle ].numberOfOperations = 0;
+	jobs[ handle ].currentOperation = 0;
+	
+	freeHandles.push_back( handle );
+	
+	// once most of the operation table belongs to jobs that are gone, 
+	// move the rest together so the table does not keep growing
+	if( deadOperations > 4096 && deadOperations > ( operations.size() / 2 ) ) {
+		
+		compact();
+	}
+}
+
+void JobTable::compact() {
+	
+	int next = 0;
+	
+	// jobs only ever move their operations towards the front so they can
+	// be moved in place, as long as they are moved in the order they are in
+	vector<int> order;
+	
+	for( int i = 0; i < (int) jobs.size(); i++ ) {
+		
+		if( jobs[ i ].numberOfOperations > 0 ) {
+			
+			order.push_back( i );
+		}
+	}
+	
+	sort( order.begin(), order.end(), [ this ]( int a, int b ) {
+		
+		return ( jobs[ a ].firstOperation < jobs[ b ].firstOperation );
+	} );
+	
+	for( int i = 0; i < (int) order.size(); i++ ) {
+		
+		Job &job = jobs[ order[ i ] ];
+		
+		for( int j = 0; j < job.numberOfOperations; j++ ) {
+			
+			operations.types[ next + j ] = operations.types[ job.firstOperation + j ];
+			operations.devices[ next + j ] = operations.devices[ job.firstOperation + j ];
+			operations.cycleTimes[ next + j ] = operations.cycleTimes[ job.firstOperation + j ];
+		}
+		
+		job.firstOperation = next;
+		next += job.numberOfOperations;
+	}
+	
+	operations.types.resize( next );
+	operations.devices.resize( next );
+	operations.cycleTimes.resize( next );
+	operations.refresh();
+	
+	deadOperations = 0;
+}
+
+void JobTable::clear() {
+	
+	jobs.clear();
+	freeHandles.clear();
+	
+	operations.types.clear();
+	operations.devices.clear();
+	operations.cycleTimes.clear();
+	operations.refresh();
+	
+	deadOperations = 0;
+	shared = NULL;
+}
+
+void JobTable::share( JobTable &other ) {
+	
+	clear();
+	
+	jobs = other.jobs;
+	shared = &other.ops();
+}
+
+void JobTable::track( bool on ) {
+	
+	tracking = on;
+	touched.assign( jobs.size(), false );
+	touchedJobs.clear();
+}
+
+void JobTable::recost( DeviceTable &devices ) {
+	
+	OperationTable &table = ops();
+	
+	for( int i = 0; i < (int) jobs.size(); i++ ) {
+		
+		Job &job = jobs[ i ];
+		
+		job.timeToProcessJob = 0;
+		
+		for( int j = 0; j < job.numberOfOperations; j++ ) {
+			
+			int index = job.firstOperation + j;
+			job.timeToProcessJob += devices.cost( table.device( index ), table.cycles( index ) );
+		}
+	}
+}
@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+// a min-heap of job handles ordered by a key, ties come out in the order
+// they went in so runs always come out the same.. a job is only ever put
+// in when it is not in already, a job doing io is never waiting in it, so
+// there is no key to change & nothing is taken out but the smallest
+class JobHeap {
+	
+	public:
+		
+		// constructor
+		JobHeap() {
+			
+			nextOrder = 0;
+		}
+		
+		// adds the job with the key
+		void push( int handle, long key ) {
+			
+			Entry entry;
+			
+			entry.key = key;
+			entry.order = nextOrder++;
+			entry.handle = handle;
+			
+			heap.push_back( entry );
+			push_heap( heap.begin(), heap.end(), Later() );
+		}
+		
+		// takes the job with the smallest key out & returns it
+		int pop() {
+			
+			pop_heap( heap.begin(), heap.end(), Later() );
+			
+			int handle = heap.back().handle;
+			heap.pop_back();
+			
+			return handle;
+		}
+		
+		bool empty() {
+			
+			return heap.empty();
+		}
+		
+		int size() {
+			
+			return heap.size();
+		}
+	
+	private:
+		
+		// the checkpoint saves & restores the heap as it is
+		friend class Checkpoint;
+		
+		struct Entry {
+			
+			long key;
+			long order;	// when the job went in, breaks ties in the key
+			int handle;
+		};
+		
+		// orders the heap so the smallest key is on top
+		struct Later {
+			
+			bool operator()( const Entry &a, const Entry &b ) const {
+				
+				if( a.key != b.key ) {
+					
+					return ( a.key > b.key );
+				}
+				
+				return ( a.order > b.order );
+			}
+		};
+		
+		vector<Entry> heap; // a heap ordered by Later, the smallest key is at the front
+		
+		long nextOrder;
+};
@@ -0,0 +1,101 @@
+#include "Job.cpp"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// the job stream hands jobs from the thread reading the metadata to the
+// scheduler while the simulation is already running.. it is a fixed size
+// ring of slots with one writer & one reader, each slot is a small job
+// table that holds a single job.. the slots are reused so once the ring
+// has gone around once no more memory is allocated, & the reader & writer
+// only ever share the head & tail counters so no locks are needed
+class JobStream {
+	
+	public:
+		
+		// constructor, the capacity is how many jobs can be waiting at once
+		JobStream( int );
+		
+		// writer side, reserve waits for a free slot & returns it empty,
+		// publish hands it to the reader & close says no more are coming
+		JobTable &reserve();
+		void publish();
+		void close();
+		
+		// reader side, front returns the oldest job waiting or NULL if
+		// there is none right now, release gives the slot back to the writer
+		JobTable *front();
+		void release();
+		
+		// true once the writer closed the stream & every job was read
+		bool drained();
+	
+	private:
+		
+		vector<JobTable> slots;
+		
+		atomic<long> head;	// next slot the reader takes, only the reader moves it
+		atomic<long> tail;	// next slot the writer fills, only the writer moves it
+		atomic<bool> closed;
+};
+
+JobStream::JobStream( int capacity ) : slots( capacity ) {
+	
+	head = 0;
+	tail = 0;
+	closed = false;
+}
+
+JobTable &JobStream::reserve() {
+	
+	long slot = tail.load( memory_order_relaxed );
+	
+	// the ring is full, wait for the reader to free a slot
+	while( slot - head.load( memory_order_acquire ) == (long) slots.size() ) {
+		
+		this_thread::yield();
+	}
+	
+	JobTable &table = slots[ slot % slots.size() ];
+	table.clear();
+	
+	return table;
+}
+
+void JobStream::publish() {
+	
+	// release so the reader sees the whole job before it sees the new tail
+	tail.store( tail.load( memory_order_relaxed ) + 1, memory_order_release );
+}
+
+void JobStream::close() {
+	
+	closed.store( true, memory_order_release );
+}
+
+JobTable *JobStream::front() {
+	
+	long slot = head.load( memory_order_relaxed );
+	
+	if( slot == tail.load( memory_order_acquire ) ) {
+		
+		return NULL;
+	}
+	
+	return &slots[ slot % slots.size() ];
+}
+
+void JobStream::release() {
+	
+	head.store( head.load( memory_order_relaxed ) + 1, memory_order_release );
+}
+
+bool JobStream::drained() {
+	
+	// closed has to be checked first, a job could be published between
+	// the two checks otherwise & it would be missed
+	return ( closed.load( memory_order_acquire ) &&
+			 head.load( memory_order_relaxed ) == tail.load( memory_order_acquire ) );
+}
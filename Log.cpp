@@ -0,0 +1,399 @@
+#include "Profiler.cpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+// how much gets logged, every level logs everything the levels before it do
+enum LogLevel {
+	
+	LOG_NONE,	// nothing at all
+	LOG_SYSTEM,	// boot, shutdown & the utilization at the end
+	LOG_JOBS,	// jobs entering & leaving the system
+	LOG_ALL		// every slice, io operation & swap
+};
+
+// the log takes the lines the simulation prints & writes them to the
+// console, a file or both on a thread of its own.. a line is formatted
+// straight into a ring buffer & only handed over once it is finished, the
+// writer thread takes everything that is ready in one go so the simulation
+// never waits on a write or a flush.. there is one thread putting lines
+// in & one taking them out so the ring only needs the head & tail counters..
+// a paced run writes every line itself as soon as it is finished, the
+// writer could otherwise hold a line back until long after its time
+class Log {
+	
+	public:
+		
+		// constructor & destructor
+		Log();
+		~Log();
+		
+		// starts writing to where the Log: setting of the config says, the
+		// console, the file or both.. the file is started over unless it is
+		// given the number of bytes of it to keep, then the log carries on
+		// after them.. returns false if the file could not be opened
+		bool open( string, string, long = -1 );
+		
+		// waits for everything logged so far to be written & stops the writer
+		void close();
+		
+		// waits for everything logged so far to be written
+		void flush();
+		
+		// bytes logged since the file was started, counting any that were kept
+		long logged() {
+			
+			return tail.load( memory_order_relaxed );
+		}
+		
+		// starts a line, if the level of the line is above the level of
+		// the log everything up to the end of the line is thrown away
+		Log &line( int );
+		
+		Log &operator<<( const char * );
+		Log &operator<<( const string & );
+		Log &operator<<( char );
+		Log &operator<<( int );
+		Log &operator<<( long );
+		Log &operator<<( double );
+		
+		// endl finishes the line & hands it to the writer, nothing is flushed
+		Log &operator<<( ostream &(*)( ostream & ) );
+		
+		int level; // lines above this level are not logged
+		int digits; // digits after the decimal point doubles are logged with
+		bool direct; // lines are written when they are finished & there is no writer, set before it is opened
+	
+	private:
+		
+		// puts the bytes on the end of the line that is being made
+		void append( const char *, size_t );
+		
+		// the writer thread, writes out whatever is in the ring until closed
+		void drain();
+		
+		// writes out every finished line in the ring
+		void writeReady();
+		
+		// writes the bytes to every place the log goes to
+		void writeOut( const char *, size_t );
+		
+		static const size_t CAPACITY = 1 << 22; // size of the ring, has to be a power of 2
+		static const size_t LONGEST_LINE = 1024; // longer lines are cut off
+		
+		vector<char> ring;
+		
+		atomic<size_t> head; // next byte the writer takes, only the writer moves it
+		atomic<size_t> tail; // end of the last finished line, only the simulation moves it
+		atomic<bool> closed;
+		
+		size_t lineStart; // where the line being made starts in the ring
+		size_t lineEnd; // where the next byte of the line being made goes
+		bool skipping; // the line being made is not logged
+		
+		vector<int> files; // descriptors the log writes to
+		int logFile; // descriptor of the log file, -1 if there is none
+		
+		thread writer;
+};
+
+Log::Log() : ring( CAPACITY ) {
+	
+	level = LOG_ALL;
+	digits = 1;
+	direct = false;
+	
+	head = 0;
+	tail = 0;
+	closed = false;
+	
+	lineStart = 0;
+	lineEnd = 0;
+	skipping = false;
+	
+	logFile = -1;
+}
+
+Log::~Log() {
+	
+	close();
+}
+
+bool Log::open( string logType, string filename, long keep ) {
+	
+	// log to both or log to file, log to monitor & log to console are both
+	// the console
+	bool toFile = ( logType.find( "File" ) != string::npos || logType.find( "Both" ) != string::npos );
+	bool toConsole = ( logType.find( "File" ) == string::npos );
+	
+	if( toConsole ) {
+		
+		files.push_back( STDOUT_FILENO );
+	}
+	
+	if( toFile ) {
+		
+		logFile = ::open( filename.c_str(), O_WRONLY | O_CREAT | ( keep < 0 ? O_TRUNC : 0 ), 0644 );
+		
+		// anything after the bytes that are kept was logged by a run that
+		// did not finish, it is logged again
+		if( logFile != -1 && keep >= 0 && ( ftruncate( logFile, keep ) == -1 || lseek( logFile, keep, SEEK_SET ) == -1 ) ) {
+			
+			::close( logFile );
+			logFile = -1;
+		}
+		
+		if( logFile != -1 ) {
+			
+			files.push_back( logFile );
+		}
+	}
+	
+	// the ring carries on counting from the bytes that were kept, where a
+	// byte goes in the ring only depends on the low bits of its count
+	if( keep > 0 ) {
+		
+		head = keep;
+		tail = keep;
+		lineStart = keep;
+		lineEnd = keep;
+	}
+	
+	// the writer is started even if the file could not be opened, so
+	// whatever was logged still goes somewhere or is at least taken out
+	if( !direct ) {
+		
+		writer = thread( &Log::drain, this );
+	}
+	
+	return ( !toFile || logFile != -1 );
+}
+
+void Log::close() {
+	
+	if( writer.joinable() ) {
+		
+		closed.store( true, memory_order_release );
+		writer.join();
+	}
+	
+	if( logFile != -1 ) {
+		
+		::close( logFile );
+		logFile = -1;
+	}
+	
+	files.clear();
+}
+
+void Log::flush() {
+	
+	// the writer moves the head up to the tail once it has written it all
+	while( writer.joinable() && head.load( memory_order_acquire ) != tail.load( memory_order_relaxed ) ) {
+		
+		this_thread::yield();
+	}
+}
+
+Log &Log::line( int lineLevel ) {
+	
+	skipping = ( lineLevel > level );
+	
+	if( skipping ) {
+		
+		return *this;
+	}
+	
+	// make sure the longest line fits before it is started, so nothing
+	// has to be checked while it is being made
+	while( CAPACITY - ( tail.load( memory_order_relaxed ) - head.load( memory_order_acquire ) ) < LONGEST_LINE ) {
+		
+		this_thread::yield();
+	}
+	
+	lineStart = tail.load( memory_order_relaxed );
+	lineEnd = lineStart;
+	
+	return *this;
+}
+
+void Log::append( const char *text, size_t length ) {
+	
+	if( skipping ) {
+		
+		return;
+	}
+	
+	// one byte is kept for the new line
+	length = min( length, LONGEST_LINE - 1 - ( lineEnd - lineStart ) );
+	
+	size_t at = lineEnd & ( CAPACITY - 1 );
+	size_t first = min( length, CAPACITY - at );
+	
+	// the line might run off the end of the ring & carry on at the front
+	memcpy( &ring[ at ], text, first );
+	memcpy( &ring[ 0 ], text + first, length - first );
+	
+	lineEnd += length;
+}
+
+Log &Log::operator<<( const char *text ) {
+	
+	append( text, strlen( text ) );
+	return *this;
+}
+
+Log &Log::operator<<( const string &text ) {
+	
+	append( text.data(), text.size() );
+	return *this;
+}
+
+Log &Log::operator<<( char c ) {
+	
+	append( &c, 1 );
+	return *this;
+}
+
+Log &Log::operator<<( int number ) {
+	
+	return ( *this << (long) number );
+}
+
+// numbers are written out by hand from the last digit to the first, this
+// is a lot faster than going through a stream & its locale
+Log &Log::operator<<( long number ) {
+	
+	char digitsOut[ 24 ];
+	char *p = digitsOut + sizeof( digitsOut );
+	unsigned long value = ( number < 0 ? -(unsigned long) number : number );
+	
+	if( skipping ) {
+		
+		return *this;
+	}
+	
+	do {
+		
+		*--p = '0' + value % 10;
+		value /= 10;
+	} while( value != 0 );
+	
+	if( number < 0 ) {
+		
+		*--p = '-';
+	}
+	
+	append( p, digitsOut + sizeof( digitsOut ) - p );
+	return *this;
+}
+
+Log &Log::operator<<( double number ) {
+	
+	char text[ 64 ];
+	
+	if( skipping ) {
+		
+		return *this;
+	}
+	
+	append( text, snprintf( text, sizeof( text ), "%.*f", digits, number ) );
+	return *this;
+}
+
+Log &Log::operator<<( ostream &(*)( ostream & ) ) {
+	
+	if( skipping ) {
+		
+		return *this;
+	}
+	
+	// append always leaves room for the new line
+	ring[ lineEnd & ( CAPACITY - 1 ) ] = '\n';
+	lineEnd++;
+	
+	// release so the writer sees the whole line before it sees the new tail
+	tail.store( lineEnd, memory_order_release );
+	
+	if( direct ) {
+		
+		writeReady();
+	}
+	
+	return *this;
+}
+
+void Log::drain() {
+	
+	while( true ) {
+		
+		// closed has to be checked before the tail, a line finished in
+		// between would be missed otherwise
+		bool done = closed.load( memory_order_acquire );
+		size_t start = head.load( memory_order_relaxed );
+		size_t end = tail.load( memory_order_acquire );
+		
+		if( start == end ) {
+			
+			if( done ) {
+				
+				return;
+			}
+			
+			// nothing to write, let the simulation get ahead so the next
+			// write has more in it
+			this_thread::sleep_for( chrono::milliseconds( 1 ) );
+			continue;
+		}
+		
+		writeReady();
+	}
+}
+
+void Log::writeReady() {
+	
+	size_t start = head.load( memory_order_relaxed );
+	size_t end = tail.load( memory_order_acquire );
+	
+	// everything ready is written at once, in two parts if it runs off
+	// the end of the ring
+	size_t at = start & ( CAPACITY - 1 );
+	size_t first = min( end - start, CAPACITY - at );
+	
+	writeOut( &ring[ at ], first );
+	writeOut( &ring[ 0 ], ( end - start ) - first );
+	
+	head.store( end, memory_order_release );
+}
+
+void Log::writeOut( const char *bytes, size_t length ) {
+	
+	PROFILE_SCOPE( PROFILE_LOG_WRITE );
+	
+	for( int i = 0; i < (int) files.size(); i++ ) {
+		
+		size_t written = 0;
+		
+		// a write can take less than it was given, keep going until it is all out
+		while( written < length ) {
+			
+			ssize_t result = write( files[ i ], bytes + written, length - written );
+			
+			if( result <= 0 ) {
+				
+				break;
+			}
+			
+			written += result;
+		}
+	}
+}
@@ -0,0 +1,382 @@
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+// the ways main memory can be handed out, picked with the Memory type line
+// of the config
+enum MemoryType {
+	
+	MEMORY_FIXED,	// the memory is split into partitions all the same size, a job gets a whole one
+	MEMORY_BUDDY,	// a job gets the smallest power of 2 block it fits in, blocks split & join as needed
+	MEMORY_PAGED	// a job gets as many frames as it has pages, any frames will do
+};
+
+// the memory manager decides if a job can have the memory it needs, every
+// size is in KB.. each kind of memory keeps its free space so that giving
+// out & taking back memory costs the same however many jobs there are:
+//
+//	fixed	- a stack of the free partitions
+//	buddy	- a list of the free blocks of every size & a bitmap of which
+//			  sizes have a free block, so the smallest free block big
+//			  enough is found with one bit scan.. only the free blocks
+//			  are kept, so a memory of terabytes costs no more than one
+//			  of a few KB
+//	paged	- only the number of free frames, which frame a job gets does
+//			  not matter to the simulation
+class MemoryManager {
+	
+	public:
+		
+		// biggest memory ( KB ) that can be simulated, every block starts at
+		// a KB that has to fit in a long with room for its buddy
+		static const long MAX_SIZE = 1L << 62;
+		
+		// constructor, the memory starts out unlimited
+		MemoryManager();
+		
+		// sets up the memory of the type & size, the partitions are only used
+		// by fixed memory & the page size by paged memory.. a size of 0
+		// leaves the memory unlimited
+		void setup( int, long, int, long );
+		
+		// true if the memory is limited, otherwise every job gets what it needs
+		bool managed() {
+			
+			return ( size > 0 );
+		}
+		
+		// true if the memory could ever give a job that much, even with
+		// nothing else in it
+		bool fits( long );
+		
+		// gives out the memory & returns where it is, -1 if there is not
+		// enough free right now
+		long allocate( long );
+		
+		// counts a job that could not have the memory it needed when it
+		// arrived, a job is only counted once however often it tries again
+		void failed( long );
+		
+		// takes back memory that was given out for the size
+		void release( long, long );
+		
+		// name of the memory type, used for printing
+		string typeName();
+		
+		int type;
+		long size; // KB of memory, 0 if it is unlimited
+		
+		long inUse; // KB given out right now, counting what is given but not asked for
+		long peakInUse;
+		
+		long allocations; // times memory was given out
+		long failures; // jobs that arrived when there was not enough memory free for them
+		long fragmentedFailures; // failures where enough was free but not in one piece
+		long requested; // KB asked for over every allocation
+		long given; // KB given out over every allocation, the rest of it is internal fragmentation
+	
+	private:
+		
+		// the checkpoint saves & restores the free memory as it is
+		friend class Checkpoint;
+		
+		// the part of the memory actually given out for the size
+		long blockSize( long );
+		
+		// order of the smallest buddy block the size fits in, a block of
+		// order k is 2 to the k KB
+		int order( long );
+		
+		// puts a buddy block on the free list of its order or takes it off
+		void pushBlock( long, int );
+		void removeBlock( long, int );
+		
+		// fixed memory
+		long partitionSize;
+		vector<int> freePartitions;
+		
+		// a free buddy block, linked into the list of its order
+		struct FreeBlock {
+			
+			long next;
+			long previous;
+			int order;
+		};
+		
+		// buddy memory, the free blocks are found by the KB they start at
+		unordered_map<long, FreeBlock> freeBlocks;
+		vector<long> freeHead; // first free block of every order, -1 if there is none
+		unsigned long freeOrders; // bit k is set if a block of order k is free
+		
+		// paged memory
+		long pageSize;
+		long freeFrames;
+};
+
+MemoryManager::MemoryManager() {
+	
+	type = MEMORY_FIXED;
+	size = 0;
+	inUse = 0;
+	peakInUse = 0;
+	
+	allocations = 0;
+	failures = 0;
+	fragmentedFailures = 0;
+	requested = 0;
+	given = 0;
+	
+	partitionSize = 0;
+	freeOrders = 0;
+	pageSize = 1;
+	freeFrames = 0;
+}
+
+void MemoryManager::setup( int memoryType, long memorySize, int partitions, long memoryPageSize ) {
+	
+	type = memoryType;
+	size = max( 0L, memorySize );
+	
+	if( size == 0 ) {
+		
+		return;
+	}
+	
+	if( type == MEMORY_FIXED ) {
+		
+		// a partition is at least 1 KB, there can not be more than there are KB
+		partitions = (int) min( (long) max( 1, partitions ), size );
+		partitionSize = size / partitions;
+		
+		// the first partition is on top so it is given out first
+		for( int i = partitions - 1; i >= 0; i-- ) {
+			
+			freePartitions.push_back( i );
+		}
+	}
+	else if( type == MEMORY_BUDDY ) {
+		
+		freeHead.assign( 64, -1 );
+		
+		// memory that is not a power of 2 starts out as the biggest blocks
+		// that fit one after another, biggest first so each block starts on
+		// a multiple of its own size
+		long start = 0;
+		
+		for( int k = 63 - __builtin_clzl( size ); k >= 0; k-- ) {
+			
+			if( size & ( 1L << k ) ) {
+				
+				pushBlock( start, k );
+				start += 1L << k;
+			}
+		}
+	}
+	else {
+		
+		pageSize = max( 1L, memoryPageSize );
+		freeFrames = size / pageSize;
+	}
+}
+
+bool MemoryManager::fits( long needed ) {
+	
+	if( !managed() ) {
+		
+		return true;
+	}
+	
+	if( type == MEMORY_FIXED ) {
+		
+		return ( needed <= partitionSize );
+	}
+	
+	if( type == MEMORY_BUDDY ) {
+		
+		return ( needed <= ( 1L << ( 63 - __builtin_clzl( size ) ) ) );
+	}
+	
+	return ( ( needed + pageSize - 1 ) / pageSize <= size / pageSize );
+}
+
+long MemoryManager::blockSize( long needed ) {
+	
+	if( type == MEMORY_FIXED ) {
+		
+		return partitionSize;
+	}
+	
+	if( type == MEMORY_BUDDY ) {
+		
+		return ( 1L << order( needed ) );
+	}
+	
+	return ( ( needed + pageSize - 1 ) / pageSize * pageSize );
+}
+
+int MemoryManager::order( long needed ) {
+	
+	return ( needed <= 1 ? 0 : 64 - __builtin_clzl( needed - 1 ) );
+}
+
+long MemoryManager::allocate( long needed ) {
+	
+	long where = -1;
+	
+	if( type == MEMORY_FIXED ) {
+		
+		if( !freePartitions.empty() ) {
+			
+			where = freePartitions.back();
+			freePartitions.pop_back();
+		}
+	}
+	else if( type == MEMORY_BUDDY ) {
+		
+		int k = order( needed );
+		unsigned long bigEnough = ( k < 64 ? freeOrders >> k << k : 0 );
+		
+		// the smallest free block that is big enough is split in half until
+		// it is the size needed, the half that is not used is freed each time
+		if( bigEnough != 0 ) {
+			
+			int j = __builtin_ctzl( bigEnough );
+			
+			where = freeHead[ j ];
+			removeBlock( where, j );
+			
+			while( j > k ) {
+				
+				j--;
+				pushBlock( where + ( 1L << j ), j );
+			}
+		}
+	}
+	else if( ( needed + pageSize - 1 ) / pageSize <= freeFrames ) {
+		
+		freeFrames -= ( needed + pageSize - 1 ) / pageSize;
+		where = 0;
+	}
+	
+	if( where == -1 ) {
+		
+		return -1;
+	}
+	
+	allocations++;
+	requested += needed;
+	given += blockSize( needed );
+	inUse += blockSize( needed );
+	peakInUse = max( peakInUse, inUse );
+	
+	return where;
+}
+
+void MemoryManager::failed( long needed ) {
+	
+	failures++;
+	
+	if( size - inUse >= needed ) {
+		
+		fragmentedFailures++;
+	}
+}
+
+void MemoryManager::release( long where, long needed ) {
+	
+	inUse -= blockSize( needed );
+	
+	if( type == MEMORY_FIXED ) {
+		
+		freePartitions.push_back( where );
+	}
+	else if( type == MEMORY_BUDDY ) {
+		
+		int k = order( needed );
+		
+		// the block joins up with its buddy for as long as the buddy is free
+		// & whole, the buddy of a block is the other half of the block
+		// they were split from
+		while( true ) {
+			
+			long buddy = where ^ ( 1L << k );
+			unordered_map<long, FreeBlock>::iterator found = freeBlocks.find( buddy );
+			
+			if( buddy + ( 1L << k ) > size || found == freeBlocks.end() || found->second.order != k ) {
+				
+				break;
+			}
+			
+			removeBlock( buddy, k );
+			where = min( where, buddy );
+			k++;
+		}
+		
+		pushBlock( where, k );
+	}
+	else {
+		
+		freeFrames += ( needed + pageSize - 1 ) / pageSize;
+	}
+}
+
+void MemoryManager::pushBlock( long block, int k ) {
+	
+	FreeBlock &entry = freeBlocks[ block ];
+	
+	entry.next = freeHead[ k ];
+	entry.previous = -1;
+	entry.order = k;
+	
+	if( freeHead[ k ] != -1 ) {
+		
+		freeBlocks[ freeHead[ k ] ].previous = block;
+	}
+	
+	freeHead[ k ] = block;
+	freeOrders |= 1UL << k;
+}
+
+void MemoryManager::removeBlock( long block, int k ) {
+	
+	FreeBlock entry = freeBlocks[ block ];
+	
+	if( entry.previous != -1 ) {
+		
+		freeBlocks[ entry.previous ].next = entry.next;
+	}
+	else {
+		
+		freeHead[ k ] = entry.next;
+	}
+	
+	if( entry.next != -1 ) {
+		
+		freeBlocks[ entry.next ].previous = entry.previous;
+	}
+	
+	freeBlocks.erase( block );
+	
+	if( freeHead[ k ] == -1 ) {
+		
+		freeOrders &= ~( 1UL << k );
+	}
+}
+
+string MemoryManager::typeName() {
+	
+	if( type == MEMORY_BUDDY ) {
+		
+		return "BUDDY";
+	}
+	
+	if( type == MEMORY_PAGED ) {
+		
+		return "PAGED";
+	}
+	
+	return "FIXED";
+}
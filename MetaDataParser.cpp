@@ -0,0 +1,501 @@
+#include "Policy.cpp"
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+// a single operation as it is written in the metadata, like P(run)13;
+// the instruction points straight into the mapped file so reading a
+// token never allocates
+struct MetaDataToken {
+	
+	char type;	// S, A, P, I, O or M
+	string_view instruction;	// text between the ( )
+	int cycleTime;	// number after the ( )
+	size_t offset;	// where the token starts in the file, used for errors
+};
+
+// reads the metadata file one job at a time.. the file is memory mapped
+// & scanned in place, the operations of a job are put straight into the
+// job table with their device already interned so there are no strings
+// made for any of the operations
+class MetaDataParser {
+	
+	public:
+		
+		// constructor & destructor
+		MetaDataParser();
+		~MetaDataParser();
+		
+		// maps the file into memory, returns false if it could not be opened
+		bool open( string );
+		void close();
+		
+		// reads the next job into the job table & sets the handle of it,
+		// returns false once S(end) is reached or if the metadata is bad
+		bool nextJob( JobTable &, DeviceTable &, int & );
+		
+		// reads every job into the job table, the file is split into parts
+		// that are read at the same time on the given number of threads..
+		// the jobs end up in the table in the same order as in the file
+		bool readAllJobs( JobTable &, DeviceTable &, int );
+		
+		// true if the metadata was bad, the error says where & why
+		bool failed() {
+			
+			return !error.empty();
+		}
+		
+		string error;
+	
+	private:
+		
+		// reads the next token, returns false if it is malformed
+		bool nextToken( MetaDataToken & );
+		
+		// records the error at the given offset & returns false
+		bool fail( size_t, string );
+		
+		// finds the next ( ) or ; starting at the pointer
+		const char *findDelimiter( const char *, const char * );
+		
+		// skips spaces, tabs & new lines
+		const char *skipWhitespace( const char *, const char * );
+		
+		// reads only the part of the file of another parser from the
+		// begin offset to the first job that starts after the end offset
+		void attach( MetaDataParser &, size_t, size_t );
+		
+		// offset of the first A(start) at or after the offset
+		size_t findJobStart( size_t );
+		
+		string filename;
+		
+		const char *data;	// the mapped file
+		size_t length;	// size of the mapped file
+		size_t position;	// where the next token starts
+		size_t rangeEnd;	// no job is started at or after this offset
+		
+		bool ownsMapping;	// only the parser that mapped the file unmaps it
+		
+		bool started;	// S(start) has been read
+		bool ended;		// S(end) has been read
+};
+
+MetaDataParser::MetaDataParser() {
+	
+	data = NULL;
+	length = 0;
+	position = 0;
+	rangeEnd = 0;
+	started = false;
+	ended = false;
+	ownsMapping = false;
+}
+
+MetaDataParser::~MetaDataParser() {
+	
+	close();
+}
+
+bool MetaDataParser::open( string file ) {
+	
+	struct stat info;
+	
+	filename = file;
+	
+	int fd = ::open( filename.c_str(), O_RDONLY );
+	
+	if( fd == -1 ) {
+		
+		error = filename + ": could not open metadata file";
+		return false;
+	}
+	
+	if( fstat( fd, &info ) == -1 || info.st_size == 0 ) {
+		
+		::close( fd );
+		error = filename + ": metadata file is empty";
+		return false;
+	}
+	
+	length = info.st_size;
+	
+	void *mapping = mmap( NULL, length, PROT_READ, MAP_PRIVATE, fd, 0 );
+	
+	// the mapping keeps the file open, the descriptor is not needed anymore
+	::close( fd );
+	
+	if( mapping == MAP_FAILED ) {
+		
+		length = 0;
+		error = filename + ": could not map metadata file";
+		return false;
+	}
+	
+	// the file is read from front to back, let the kernel read ahead
+	madvise( mapping, length, MADV_SEQUENTIAL );
+	
+	data = (const char *) mapping;
+	position = 0;
+	rangeEnd = length;
+	ownsMapping = true;
+	
+	return true;
+}
+
+void MetaDataParser::close() {
+	
+	if( data != NULL && ownsMapping ) {
+		
+		munmap( (void *) data, length );
+		data = NULL;
+		length = 0;
+	}
+}
+
+bool MetaDataParser::fail( size_t offset, string message ) {
+	
+	// only keep the first error, anything after it is caused by it
+	if( error.empty() ) {
+		
+		error = filename + ": offset " + to_string( offset ) + ": " + message;
+	}
+	
+	return false;
+}
+
+// 16 bytes are checked at a time for any of the three delimiters, the
+// compare results are or'd together & the first set bit is the delimiter
+const char *MetaDataParser::findDelimiter( const char *p, const char *end ) {
+
+#ifdef __SSE2__
+	const __m128i open = _mm_set1_epi8( '(' );
+	const __m128i close = _mm_set1_epi8( ')' );
+	const __m128i semicolon = _mm_set1_epi8( ';' );
+	
+	while( end - p >= 16 ) {
+		
+		__m128i block = _mm_loadu_si128( (const __m128i *) p );
+		
+		__m128i hits = _mm_or_si128( _mm_cmpeq_epi8( block, open ),
+						_mm_or_si128( _mm_cmpeq_epi8( block, close ),
+									  _mm_cmpeq_epi8( block, semicolon ) ) );
+		
+		int mask = _mm_movemask_epi8( hits );
+		
+		if( mask != 0 ) {
+			
+			return ( p + __builtin_ctz( mask ) );
+		}
+		
+		p += 16;
+	}
+#endif
+	
+	// whatever is left over is less than 16 bytes
+	while( p < end && *p != '(' && *p != ')' && *p != ';' ) {
+		
+		p++;
+	}
+	
+	return p;
+}
+
+const char *MetaDataParser::skipWhitespace( const char *p, const char *end ) {
+	
+	while( p < end && ( *p == ' ' || *p == '\n' || *p == '\r' || *p == '\t' ) ) {
+		
+		p++;
+	}
+	
+	return p;
+}
+
+// a token looks like P(run)13; the last token in the file ends with a
+// . instead of a ; so either one is allowed
+bool MetaDataParser::nextToken( MetaDataToken &token ) {
+	
+	const char *end = data + length;
+	const char *p = skipWhitespace( data + position, end );
+	
+	if( p == end ) {
+		
+		return fail( length, "unexpected end of file" );
+	}
+	
+	token.offset = p - data;
+	token.type = *p++;
+	
+	if( p == end || *p != '(' ) {
+		
+		return fail( token.offset, string( "expected '(' after '" ) + token.type + "'" );
+	}
+	
+	// the instruction is everything up to the closing )
+	const char *close = findDelimiter( ++p, end );
+	
+	if( close == end || *close != ')' ) {
+		
+		return fail( token.offset, "missing ')' after instruction" );
+	}
+	
+	token.instruction = string_view( p, close - p );
+	
+	// the cycle time comes right after the instruction
+	p = skipWhitespace( close + 1, end );
+	
+	from_chars_result result = from_chars( p, end, token.cycleTime );
+	
+	if( result.ec != errc() || token.cycleTime < 0 ) {
+		
+		return fail( p - data, string( "expected cycle count after " ) + token.type
+					 + "(" + string( token.instruction ) + ")" );
+	}
+	
+	p = skipWhitespace( result.ptr, end );
+	
+	if( p == end || ( *p != ';' && *p != '.' ) ) {
+		
+		return fail( p - data, "expected ';' after cycle count" );
+	}
+	
+	position = ( p + 1 ) - data;
+	
+	return true;
+}
+
+bool MetaDataParser::nextJob( JobTable &jobs, DeviceTable &devices, int &handle ) {
+	
+	MetaDataToken token;
+	
+	// the metadata has to start with the system start S
+	if( !started ) {
+		
+		if( !nextToken( token ) ) {
+			
+			return false;
+		}
+		
+		if( token.type != 'S' || token.instruction != "start" ) {
+			
+			return fail( token.offset, "metadata must start with S(start)" );
+		}
+		
+		started = true;
+	}
+	
+	if( ended ) {
+		
+		return false;
+	}
+	
+	// a parser reading a part of the file stops at the first job that is
+	// in the next part, a job that runs over the end is still read whole
+	if( rangeEnd < length && skipWhitespace( data + position, data + length ) >= data + rangeEnd ) {
+		
+		return false;
+	}
+	
+	if( !nextToken( token ) ) {
+		
+		return false;
+	}
+	
+	// the end of the system means there are no more jobs
+	if( token.type == 'S' && token.instruction == "end" ) {
+		
+		ended = true;
+		return false;
+	}
+	
+	if( token.type != 'A' || token.instruction != "start" ) {
+		
+		return fail( token.offset, "expected A(start) or S(end)" );
+	}
+	
+	handle = jobs.createJob();
+	Job &job = jobs[ handle ];
+	
+	// keep adding operations to the job until the A(end)
+	while( nextToken( token ) ) {
+		
+		if( token.type == 'A' ) {
+			
+			if( token.instruction != "end" ) {
+				
+				return fail( token.offset, "expected A(end) before the next A(start)" );
+			}
+			
+			return true;
+		}
+		
+		// the memory the job needs is not an operation, it is kept with the job
+		// & the memory manager gives it out when the job enters the system
+		if( token.type == 'M' ) {
+			
+			if( token.instruction != "allocate" ) {
+				
+				return fail( token.offset, "unknown memory operation \"" + string( token.instruction ) + "\"" );
+			}
+			
+			job.memory += token.cycleTime;
+			continue;
+		}
+		
+		if( token.type != 'P' && token.type != 'I' && token.type != 'O' ) {
+			
+			return fail( token.offset, string( "unknown operation type '" ) + token.type + "'" );
+		}
+		
+		Operation op;
+		
+		op.type = token.type;
+		op.device = devices.lookup( token.instruction );
+		op.cycleTime = token.cycleTime;
+		
+		// every operation in a job has to be done by a device the system knows about
+		if( op.device == -1 ) {
+			
+			return fail( token.offset, "unknown device \"" + string( token.instruction ) + "\"" );
+		}
+		
+		// only the cpu processes & it does no io, the scheduler goes by the
+		// type but the trace & the metrics go by the device
+		if( op.type == 'P' && op.device != DeviceTable::RUN ) {
+			
+			return fail( token.offset, "only run can be processed, \"" + string( token.instruction ) + "\" is an io device" );
+		}
+		
+		if( op.type != 'P' && op.device == DeviceTable::RUN ) {
+			
+			return fail( token.offset, string( "run can not be an io operation, expected P(run)" ) );
+		}
+		
+		// increment the amount of time need to complete job
+		// depending on how long the operation takes
+		job.timeToProcessJob += devices.cost( op.device, op.cycleTime );
+		
+		jobs.addOperation( handle, op );
+	}
+	
+	return false;
+}
+
+void MetaDataParser::attach( MetaDataParser &file, size_t begin, size_t end ) {
+	
+	filename = file.filename;
+	data = file.data;
+	length = file.length;
+	position = begin;
+	rangeEnd = end;
+	
+	// only the first part of the file starts with S(start)
+	started = ( begin != 0 );
+	ended = false;
+	ownsMapping = false;
+}
+
+size_t MetaDataParser::findJobStart( size_t offset ) {
+	
+	const char *found = (const char *) memmem( data + offset, length - offset, "A(start)", 8 );
+	
+	if( found == NULL ) {
+		
+		return length;
+	}
+	
+	return ( found - data );
+}
+
+bool MetaDataParser::readAllJobs( JobTable &jobs, DeviceTable &devices, int threads ) {
+	
+	// small files are not worth splitting up, each part should be at
+	// least a megabyte so the threads have something to do
+	size_t minimumPart = 1 << 20;
+	int parts = max( 1, min( threads, (int) ( length / minimumPart ) ) );
+	
+	vector<size_t> boundaries;
+	
+	// guess an even split & move every boundary forward to the start of
+	// a job, jobs do not depend on each other so each part can be read alone
+	boundaries.push_back( position );
+	
+	for( int i = 1; i < parts; i++ ) {
+		
+		size_t boundary = findJobStart( max( boundaries.back() + 1, length / parts * i ) );
+		
+		if( boundary >= length ) {
+			
+			break;
+		}
+		
+		boundaries.push_back( boundary );
+	}
+	
+	boundaries.push_back( length );
+	parts = boundaries.size() - 1;
+	
+	vector<MetaDataParser> readers( parts );
+	vector<JobTable> tables( parts );
+	vector<thread> workers;
+	
+	for( int i = 0; i < parts; i++ ) {
+		
+		readers[ i ].attach( *this, boundaries[ i ], boundaries[ i + 1 ] );
+	}
+	
+	// the first part is read on this thread, the rest get their own
+	for( int i = 1; i < parts; i++ ) {
+		
+		workers.emplace_back( [ &, i ]() {
+			
+			int handle;
+			while( readers[ i ].nextJob( tables[ i ], devices, handle ) );
+		} );
+	}
+	
+	int handle;
+	while( readers[ 0 ].nextJob( tables[ 0 ], devices, handle ) );
+	
+	for( int i = 0; i < (int) workers.size(); i++ ) {
+		
+		workers[ i ].join();
+	}
+	
+	// put the parts together in file order, the first bad part is the 
+	// error a single reader would have hit.. anything after S(end) is
+	// not part of the metadata, the same as if it was read in one go
+	for( int i = 0; i < parts; i++ ) {
+		
+		if( readers[ i ].failed() ) {
+			
+			error = readers[ i ].error;
+			return false;
+		}
+		
+		jobs.append( tables[ i ] );
+		
+		if( readers[ i ].ended ) {
+			
+			ended = true;
+			return true;
+		}
+	}
+	
+	// the last part always runs to the end of the file so it has to have
+	// either hit S(end) or failed
+	return fail( length, "unexpected end of file" );
+}
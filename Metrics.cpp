@@ -0,0 +1,354 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// a histogram keeps how many values fell into each of a fixed set of
+// buckets instead of the values themselves, so it is the same size for a
+// thousand jobs as for a billion.. the buckets double in size at every
+// power of 2 & each power of 2 is split into 16, so any percentile read
+// out of it is within 1/16 of the real value
+class Histogram {
+	
+	public:
+		
+		// constructor
+		Histogram();
+		
+		// adds a value, or the same value a number of times.. anything below
+		// 0 counts as 0
+		void add( long, long = 1 );
+		
+		// the value the given fraction of the values are at or below,
+		// like 0.99 for the 99th percentile
+		long percentile( double );
+		
+		double mean() {
+			
+			return ( count == 0 ? 0 : (double) total / count );
+		}
+		
+		long count; // values added
+		long total; // all the values added up
+		long smallest;
+		long largest;
+	
+	private:
+		
+		static const int SUB_BUCKETS = 16; // buckets every power of 2 is split into
+		static const int BUCKETS = SUB_BUCKETS * 60; // enough for every value a long can have
+		
+		// bucket the value goes in & the biggest value that goes in a bucket
+		int bucket( long );
+		long bucketTop( int );
+		
+		long counts[ BUCKETS ];
+};
+
+Histogram::Histogram() {
+	
+	count = 0;
+	total = 0;
+	smallest = 0;
+	largest = 0;
+	
+	for( int i = 0; i < BUCKETS; i++ ) {
+		
+		counts[ i ] = 0;
+	}
+}
+
+// values under 16 each have a bucket of their own, after that the top 5
+// bits of the value pick the bucket & the power of 2 it is in picks the row
+int Histogram::bucket( long value ) {
+	
+	if( value < SUB_BUCKETS ) {
+		
+		return value;
+	}
+	
+	int shift = ( 63 - __builtin_clzl( value ) ) - 4;
+	
+	return ( SUB_BUCKETS + shift * SUB_BUCKETS + ( ( value >> shift ) - SUB_BUCKETS ) );
+}
+
+long Histogram::bucketTop( int index ) {
+	
+	if( index < SUB_BUCKETS ) {
+		
+		return index;
+	}
+	
+	int shift = ( index - SUB_BUCKETS ) / SUB_BUCKETS;
+	long bottom = (long) ( SUB_BUCKETS + ( index - SUB_BUCKETS ) % SUB_BUCKETS ) << shift;
+	
+	return ( bottom + ( 1L << shift ) - 1 );
+}
+
+void Histogram::add( long value, long times ) {
+	
+	value = max( value, 0L );
+	
+	if( times <= 0 ) {
+		
+		return;
+	}
+	
+	smallest = ( count == 0 ? value : min( smallest, value ) );
+	largest = max( largest, value );
+	
+	counts[ bucket( value ) ] += times;
+	count += times;
+	total += value * times;
+}
+
+long Histogram::percentile( double fraction ) {
+	
+	long wanted = max( 1L, (long) ceil( fraction * count ) );
+	long seen = 0;
+	
+	if( count == 0 ) {
+		
+		return 0;
+	}
+	
+	for( int i = 0; i < BUCKETS; i++ ) {
+		
+		seen += counts[ i ];
+		
+		// the top of the bucket is as close as the histogram knows, but
+		// never more than the biggest value that was really added
+		if( seen >= wanted ) {
+			
+			return min( bucketTop( i ), largest );
+		}
+	}
+	
+	return largest;
+}
+
+// what happened to one job, only kept when the config asks for it
+struct JobMetrics {
+	
+	int PID;
+	long arrivalTime;	// simulated times ( msec ) the job entered, first started & exited
+	long startTime;
+	long exitTime;
+	long serviceTime;	// time ( msec ) the job needed on the cpu & devices
+};
+
+// the metrics are worked out from the same points the scheduler logs at,
+// so they come out the same whatever the log level is.. the distributions
+// go into histograms & the numbers for the whole system are added by the
+// scheduler at the end, then it is all written to a CSV or JSON file
+class Metrics {
+	
+	public:
+		
+		// constructor
+		Metrics() {
+			
+			keepJobs = false;
+		}
+		
+		// a slice ran on a core for the time ( msec ), or that many slices
+		// of the same time ran one after another
+		void slice( long time, long count = 1 ) {
+			
+			slices.add( time, count );
+		}
+		
+		// a device did an io operation in the time ( msec ), or that many
+		// operations of the same time
+		void io( long time, long count = 1 ) {
+			
+			ios.add( time, count );
+		}
+		
+		// a job left the system, it needed the service time ( msec ) to do
+		// all its operations & everything else it spent waiting
+		void exit( int, long, long, long, long );
+		
+		// a number about the whole system, like the utilization of a device
+		void system( string name, double value ) {
+			
+			systemValues.push_back( make_pair( name, value ) );
+		}
+		
+		// writes everything to the file, as CSV if the file ends in .csv &
+		// as JSON otherwise.. returns false if it could not be written
+		bool write( string );
+		
+		bool keepJobs; // keep the metrics of every job, not just the histograms
+		
+		Histogram turnaround; // from entering to exiting
+		Histogram waiting; // turnaround less the service time
+		Histogram response; // from entering to first getting a core or device
+		Histogram slices; // length of every slice
+		Histogram ios; // length of every io operation
+	
+	private:
+		
+		// the checkpoint saves the metrics of the jobs as they are added
+		friend class Checkpoint;
+		
+		void writeCSV( ofstream & );
+		void writeJSON( ofstream & );
+		
+		// writes a number of the system, counts like the jobs without decimals
+		void writeValue( ofstream &, double );
+		
+		vector< pair<string, double> > systemValues;
+		vector<JobMetrics> jobs;
+};
+
+void Metrics::exit( int PID, long arrivalTime, long startTime, long exitTime, long serviceTime ) {
+	
+	turnaround.add( exitTime - arrivalTime );
+	waiting.add( exitTime - arrivalTime - serviceTime );
+	response.add( startTime - arrivalTime );
+	
+	if( keepJobs ) {
+		
+		JobMetrics job;
+		
+		job.PID = PID;
+		job.arrivalTime = arrivalTime;
+		job.startTime = startTime;
+		job.exitTime = exitTime;
+		job.serviceTime = serviceTime;
+		
+		jobs.push_back( job );
+	}
+}
+
+bool Metrics::write( string filename ) {
+	
+	ofstream fout( filename.c_str() );
+	
+	if( !fout ) {
+		
+		return false;
+	}
+	
+	fout << fixed << setprecision( 3 );
+	
+	if( filename.size() >= 4 && filename.compare( filename.size() - 4, 4, ".csv" ) == 0 ) {
+		
+		writeCSV( fout );
+	}
+	else {
+		
+		writeJSON( fout );
+	}
+	
+	fout.close();
+	
+	return !fout.fail();
+}
+
+// a table for the system, one for the histograms & one for the jobs if
+// they were kept, with a blank line between them
+void Metrics::writeCSV( ofstream &fout ) {
+	
+	Histogram *histograms[] = { &turnaround, &waiting, &response, &slices, &ios };
+	const char *names[] = { "turnaround", "waiting", "response", "slice", "io" };
+	
+	fout << "metric,value" << endl;
+	
+	for( int i = 0; i < (int) systemValues.size(); i++ ) {
+		
+		fout << systemValues[ i ].first << ',';
+		writeValue( fout, systemValues[ i ].second );
+		fout << endl;
+	}
+	
+	fout << endl << "distribution,count,mean,min,p50,p90,p99,p999,max" << endl;
+	
+	for( int i = 0; i < 5; i++ ) {
+		
+		Histogram &h = *histograms[ i ];
+		
+		fout << names[ i ] << ',' << h.count << ',' << h.mean() << ',' << h.smallest << ',' << h.percentile( 0.5 ) << ','
+			 << h.percentile( 0.9 ) << ',' << h.percentile( 0.99 ) << ',' << h.percentile( 0.999 ) << ',' << h.largest << endl;
+	}
+	
+	if( keepJobs ) {
+		
+		fout << endl << "pid,arrival,start,exit,turnaround,waiting,response" << endl;
+		
+		for( int i = 0; i < (int) jobs.size(); i++ ) {
+			
+			JobMetrics &job = jobs[ i ];
+			
+			fout << job.PID << ',' << job.arrivalTime << ',' << job.startTime << ',' << job.exitTime << ','
+				 << job.exitTime - job.arrivalTime << ',' << job.exitTime - job.arrivalTime - job.serviceTime << ','
+				 << job.startTime - job.arrivalTime << endl;
+		}
+	}
+}
+
+void Metrics::writeJSON( ofstream &fout ) {
+	
+	Histogram *histograms[] = { &turnaround, &waiting, &response, &slices, &ios };
+	const char *names[] = { "turnaround", "waiting", "response", "slice", "io" };
+	
+	fout << "{" << endl << "  \"system\": {";
+	
+	for( int i = 0; i < (int) systemValues.size(); i++ ) {
+		
+		fout << ( i == 0 ? "" : "," ) << endl << "    \"" << systemValues[ i ].first << "\": ";
+		writeValue( fout, systemValues[ i ].second );
+	}
+	
+	fout << endl << "  }," << endl << "  \"distributions\": {";
+	
+	for( int i = 0; i < 5; i++ ) {
+		
+		Histogram &h = *histograms[ i ];
+		
+		fout << ( i == 0 ? "" : "," ) << endl << "    \"" << names[ i ] << "\": { \"count\": " << h.count
+			 << ", \"mean\": " << h.mean() << ", \"min\": " << h.smallest << ", \"p50\": " << h.percentile( 0.5 )
+			 << ", \"p90\": " << h.percentile( 0.9 ) << ", \"p99\": " << h.percentile( 0.99 )
+			 << ", \"p999\": " << h.percentile( 0.999 ) << ", \"max\": " << h.largest << " }";
+	}
+	
+	fout << endl << "  }";
+	
+	if( keepJobs ) {
+		
+		fout << "," << endl << "  \"jobs\": [";
+		
+		for( int i = 0; i < (int) jobs.size(); i++ ) {
+			
+			JobMetrics &job = jobs[ i ];
+			
+			fout << ( i == 0 ? "" : "," ) << endl << "    { \"pid\": " << job.PID << ", \"arrival\": " << job.arrivalTime
+				 << ", \"start\": " << job.startTime << ", \"exit\": " << job.exitTime
+				 << ", \"turnaround\": " << job.exitTime - job.arrivalTime
+				 << ", \"waiting\": " << job.exitTime - job.arrivalTime - job.serviceTime
+				 << ", \"response\": " << job.startTime - job.arrivalTime << " }";
+		}
+		
+		fout << endl << "  ]";
+	}
+	
+	fout << endl << "}" << endl;
+}
+
+void Metrics::writeValue( ofstream &fout, double value ) {
+	
+	if( value == floor( value ) && fabs( value ) < 1e15 ) {
+		
+		fout << (long) value;
+	}
+	else {
+		
+		fout << value;
+	}
+}
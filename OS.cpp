@@ -1,8 +1,10 @@
-#include "Scheduler.cpp"
+#include "Checkpoint.cpp"
 #include <iostream>
 #include <string>
 #include <fstream>
+#include <cstdlib>
 #include <queue>
+#include <sstream>
 
 using namespace std;
 
@@ -10,8 +12,12 @@ class OS {
 	
 	public:
 	
-		// constructor 
-		OS( string );
+		// constructor, resuming carries on from the checkpoint of the config
+		OS( string, bool = false );
+		
+		// an os that does not boot, the config & jobs are filled in by
+		// whoever made it before they simulate
+		OS();
 		
 		// configure & scheudler objects
 		Configure systemConfig;
@@ -19,50 +25,140 @@ class OS {
 		
 		// setup / boot function
 		void configureSystem( string );
-		void loadMetaData( queue<Job> & );
+		bool loadMetaData();
+		
+		// reads every job of the metadata into the job table, from the
+		// trace cache if it is up to date or else from the metadata itself
+		bool readMetaData();
+		
+		// gives the jobs already in the job table their PID & has them 
+		// arrive in the order they should run
+		void startJobs();
+		
+		// starts reading the metadata on its own thread, the jobs are fed
+		// to the scheduler while it is already simulating
+		bool streamMetaData();
+		
+		MetaDataParser parser; // reads the metadata file
+		TraceCache cache; // the compiled metadata, the jobs read their operations from it when it is used
+		JobTable cachedJobs; // jobs of the trace cache on their way into the stream when streaming
+		JobStream *stream; // jobs on their way from the reader to the scheduler when streaming
+		thread reader; // thread reading the metadata when streaming
+		Checkpoint checkpoint; // saves the simulation now & then so it can be resumed
 		
 		void print(); // do not need this function, just used to see 
 					  // if jobs are in the correct order preprocessing
-			
-		// used to figure out how long a job takes to complete 		  
-		void calculateTimeToProcessJob( Job &, Operation );
 		
-		// sorts the ready queue for shortest job first
-		void sortForSJF();
+		// sorts the job handles for shortest job first
+		void sortForSJF( vector<int> & );
 		
-		// simulates FIFO, SJF or RR
+		// simulates FIFO, SJF, RR, SRTF or MLFQ
 		void simulate();
+		
+		// the simulation built for one scheduling policy
+		template<class Policy> void simulatePolicy();
 };
 
-OS::OS( string filename ) {
+OS::OS( string filename, bool resume ) {
 		
+	stream = NULL;
+	
 	// configure system by reading in filename, this should be the args command line parameter
 	// configure should return bool if file open correctly, if file did not open stop program
 	// here and report the error
 	configureSystem( filename );
 	
-	// else the file opened correctly, so read in the metadata
-	loadMetaData( scheduler.readyQueue );
+	// FIFO & round robin only ever look at the jobs in the order they come
+	// in, so they can start before the whole metadata is read.. SJF has to
+	// see every job to find the shortest so it always loads everything
+	bool streaming = ( systemConfig.streamWindow > 0 && systemConfig.processorScheduling != "SJF" );
+	
+	// the jobs of a stream come & go while it is read, so there is no
+	// table of jobs to checkpoint
+	if( streaming && !systemConfig.checkpointFile.empty() ) {
+		
+		cerr << "Error: checkpoints can not be made while streaming" << endl;
+		systemConfig.checkpointFile = "";
+	}
+	
+	// a checkpoint asked for while the metadata is still read is made
+	// once the simulation starts
+	if( !systemConfig.checkpointFile.empty() ) {
+		
+		signal( SIGUSR1, requestCheckpoint );
+	}
 	
 	// transfer config file to scheduler
 	scheduler.config = systemConfig;
 	
-	// if shortest job first, then short the jobs
-	if( systemConfig.processorScheduling == "SJF" ) {
+	// a resumed run keeps the log up to the checkpoint, anything logged
+	// after it is logged again
+	long keep = -1;
+	
+	if( resume ) {
 		
-		sortForSJF();
+		if( systemConfig.checkpointFile.empty() || !checkpoint.read( systemConfig.checkpointFile, scheduler.config ) ) {
+			
+			cerr << "Error: " << systemConfig.checkpointFile << ": no checkpoint of this run to resume from" << endl;
+			return;
+		}
+		
+		keep = checkpoint.logged;
+	}
+	
+	// print to file, console or both from here on
+	scheduler.log.level = systemConfig.logLevel;
+	scheduler.log.direct = ( systemConfig.pace > 0 );
+	
+	if( !scheduler.log.open( systemConfig.logType, systemConfig.logFile, keep ) ) {
+		
+		cerr << "Error: " << systemConfig.logFile << ": could not open log file" << endl;
+	}
+	
+	// the boot is still at time 0, it is only logged once the config says
+	// where the log goes
+	if( !resume ) {
+		
+		scheduler.stamp( LOG_SYSTEM ) << "SYSTEM - Boot, Setup" << endl;
+	}
+	
+	// else the file opened correctly, so read in the metadata, if the
+	// metadata could not be read there is nothing to simulate
+	if( streaming ? !streamMetaData() : !loadMetaData() ) {
+		
+		return;
 	}
 	
 	// start simulation
 	simulate();
 	
-	// print to file, console or both
-	cout << "SYSTEM - Boot, Setup ( TIME )" << endl;
+	// everything logged is written out before any error is printed
+	scheduler.log.close();
+	
+	// the reader is done once the simulation is, anything wrong with the
+	// metadata stopped the reader & is reported here
+	if( streaming ) {
+		
+		reader.join();
+		delete stream;
+		
+		if( parser.failed() ) {
+			
+			cerr << "Error: " << parser.error << endl;
+		}
+	}
+}
+
+OS::OS() {
+	
+	stream = NULL;
 }
 
 // this function could probably return a bool if the file opened correctly
 void OS::configureSystem( string filename ) {
 	
+	PROFILE_PHASE( PROFILE_CONFIGURE );
+	
 	ifstream fin;
 	
 	fin.clear();
@@ -104,125 +200,351 @@ void OS::configureSystem( string filename ) {
 	fin.get();
 	getline( fin, systemConfig.logType, '\n' );
 	
-	fin.close();
-}
-
-void OS::loadMetaData( queue<Job> &data ) {
-	
-	ifstream fin;
-	char dummy;
-	int pidIndex = 0;
-	Operation tempOp;
-	
-	fin.clear();
-	fin.open( systemConfig.file.c_str() );
-	
-	// ready in the beginning of the metadata file
-	fin >> tempOp.type;
-	
-	// ingore the starting, we assume that the metadata should start
-	// with an S to signify the starting.. might want to check that all
-	// metadata includes the system start S at the beginning
-	fin.ignore( 256, ';' );
-	
-	// read in the first application
-	fin >> tempOp.type;
-	fin >> dummy;
-	getline( fin, tempOp.instruction, ')' );
-	fin >> tempOp.cycleTime;
-	fin >> dummy;
-	
-	// while there is still data in the file
-	while( fin.good() ) {
-
-		// if an A was hit & the instruction is start then create a
-		// new job & fill it with the operations it needs to complete
-		if( tempOp.type == 'A' && tempOp.instruction == "start" ) {
-			
-			// get first operation
-			fin >> tempOp.type;
-			fin >> dummy;
-			getline( fin, tempOp.instruction, ')' );
-			fin >> tempOp.cycleTime;
-			fin >> dummy;
-			
-			// create the job & give it a PID
-			Job tempJob;
-			tempJob.PID = ++pidIndex;
-			
-			// print to file, console or both
-			cout << "PID " << tempJob.PID << "  - Enter System" << endl;
-			cout << "SYSTEM - Creating PID " << tempJob.PID << " ( TIME )" << endl;
-			
-			// while the end of the applicaiton is not reached keep
-			// reading in opertions & putting them into the job
-			while( tempOp.type != 'A' ) {
+	// build the device cost table from the cycle times that were read in
+	systemConfig.devices.setCycleTime( DeviceTable::RUN, systemConfig.processorCycleTime );
+	systemConfig.devices.setCycleTime( DeviceTable::HARD_DRIVE, systemConfig.hardDriveCycleTime );
+	systemConfig.devices.setCycleTime( DeviceTable::KEYBOARD, systemConfig.keyboardCycleTime );
+	systemConfig.devices.setCycleTime( DeviceTable::MONITOR, systemConfig.monitorDisplayTime );
+	systemConfig.devices.setCycleTime( DeviceTable::PRINTER, systemConfig.printerCycleTime );
+	
+	// defaults for the optional settings
+	systemConfig.loaderThreads = thread::hardware_concurrency();
+	systemConfig.streamWindow = 0;
+	systemConfig.traceCache = true;
+	systemConfig.processors = 1;
+	systemConfig.affinity = false;
+	systemConfig.logFile = "log.txt";
+	systemConfig.logLevel = LOG_ALL;
+	systemConfig.metricsFile = "";
+	systemConfig.jobMetrics = false;
+	systemConfig.traceFile = "";
+	systemConfig.memorySize = 0;
+	systemConfig.memoryPartitions = 8;
+	systemConfig.pageSize = 4;
+	systemConfig.memoryFrames = 0;
+	systemConfig.mlfqLevels = 3;
+	systemConfig.mlfqBoost = 0;
+	systemConfig.checkpointFile = "";
+	systemConfig.checkpointEvents = 0;
+	systemConfig.pace = 0;
+	
+	// anything after the log line is optional, read lines until the end of
+	// the config is hit.. new devices can be added here in the form
+	// Device (scanner) cycle time (msec): 200
+	string line;
+	
+	while( getline( fin, line ) && line != "End Simulator Configuration File" ) {
+		
+		// the value of the setting is everything after the :
+		const char *value = line.c_str() + line.find( ':' ) + 1;
+		
+		// the device has to be known already, so a new device needs its
+		// Device line before this one.. Device channels (hard drive): 2
+		if( line.compare( 0, 17, "Device channels (" ) == 0 ) {
+			
+			string deviceName = line.substr( 17, line.find( ')' ) - 17 );
+			int device = systemConfig.devices.lookup( deviceName );
+			
+			if( device == -1 || atoi( value ) < 1 ) {
 				
-				// increment the amount of time need to complete job
-				// depending on how long the operation takes
-				calculateTimeToProcessJob( tempJob, tempOp );
+				cerr << "Error: bad channels for device \"" << deviceName << "\"" << endl;
+			}
+			else {
 				
-				// insert operation into the processes of the job	
-				tempJob.processes[ tempJob.currentOperation ] = tempOp;
+				systemConfig.devices.setChannels( device, atoi( value ) );
+			}
+		}
+		else if( line.compare( 0, 8, "Device (" ) == 0 ) {
+			
+			string deviceName = line.substr( 8, line.find( ')' ) - 8 );
+			
+			systemConfig.devices.registerDevice( deviceName, atoi( value ) );
+		}
+		else if( line.compare( 0, 15, "Loader threads:" ) == 0 ) {
+			
+			systemConfig.loaderThreads = atoi( value );
+		}
+		else if( line.compare( 0, 24, "Streaming window (jobs):" ) == 0 ) {
+			
+			systemConfig.streamWindow = atoi( value );
+		}
+		else if( line.compare( 0, 12, "Trace cache:" ) == 0 ) {
+			
+			systemConfig.traceCache = ( string( value ).find( "off" ) == string::npos );
+		}
+		else if( line.compare( 0, 14, "Log file path:" ) == 0 ) {
+			
+			systemConfig.logFile = line.substr( line.find_first_not_of( ' ', line.find( ':' ) + 1 ) );
+		}
+		// all logs everything, jobs leaves out the lines for every slice &
+		// io operation, system only logs boot, shutdown & the utilization
+		else if( line.compare( 0, 10, "Log level:" ) == 0 ) {
+			
+			string level( value );
+			
+			if( level.find( "none" ) != string::npos ) {
 				
-				// increment the current operation, if another operation
-				// exists then it will be placed in this index in the processes
-				tempJob.currentOperation++;
+				systemConfig.logLevel = LOG_NONE;
+			}
+			else if( level.find( "system" ) != string::npos ) {
+				
+				systemConfig.logLevel = LOG_SYSTEM;
+			}
+			else if( level.find( "jobs" ) != string::npos ) {
+				
+				systemConfig.logLevel = LOG_JOBS;
+			}
+			else {
 				
-				// get the next operation, this could be another operation
-				// or the end of the job signified by an A
-				fin >> tempOp.type;
-				fin >> dummy;
-				getline( fin, tempOp.instruction, ')' );
-				fin >> tempOp.cycleTime;
-				fin >> dummy;
+				systemConfig.logLevel = LOG_ALL;
 			}
+		}
+		// the metrics are written as CSV if the file ends in .csv, otherwise JSON
+		else if( line.compare( 0, 18, "Metrics file path:" ) == 0 ) {
 			
-			// once all the operations have been placed into the job
-			// record the number of operations this job has
-			tempJob.numberOfOperations = tempJob.currentOperation;
+			systemConfig.metricsFile = line.substr( line.find_first_not_of( ' ', line.find( ':' ) + 1 ) );
+		}
+		else if( line.compare( 0, 16, "Metrics per job:" ) == 0 ) {
 			
-			// reset the current operation to 0, this will allow you 
-			// to start processing the operations from the first operation
-			tempJob.currentOperation = 0;
+			systemConfig.jobMetrics = ( string( value ).find( "on" ) != string::npos );
+		}
+		// the trace is in the Chrome trace format, like trace.json
+		else if( line.compare( 0, 16, "Trace file path:" ) == 0 ) {
+			
+			systemConfig.traceFile = line.substr( line.find_first_not_of( ' ', line.find( ':' ) + 1 ) );
+		}
+		else if( line.compare( 0, 11, "Processors:" ) == 0 ) {
+			
+			systemConfig.processors = atoi( value );
+		}
+		else if( line.compare( 0, 19, "Processor affinity:" ) == 0 ) {
+			
+			systemConfig.affinity = ( string( value ).find( "on" ) != string::npos );
+		}
+		// the memory is unlimited unless it is given a size, or frames for PAGED
+		else if( line.compare( 0, 17, "Memory size (KB):" ) == 0 ) {
+			
+			systemConfig.memorySize = atol( value );
+		}
+		else if( line.compare( 0, 18, "Memory partitions:" ) == 0 ) {
+			
+			systemConfig.memoryPartitions = atoi( value );
+		}
+		else if( line.compare( 0, 15, "Page size (KB):" ) == 0 ) {
+			
+			systemConfig.pageSize = atol( value );
+		}
+		else if( line.compare( 0, 14, "Memory frames:" ) == 0 ) {
+			
+			systemConfig.memoryFrames = atol( value );
+		}
+		else if( line.compare( 0, 12, "MLFQ levels:" ) == 0 ) {
 			
-			// push the job onto the ready queue.
-			data.push( tempJob );
+			systemConfig.mlfqLevels = atoi( value );
 		}
+		// the quantum of every level from the top down, like 2, 4, 8, 16
+		else if( line.compare( 0, 22, "MLFQ quantum (cycles):" ) == 0 ) {
+			
+			string quantum;
+			stringstream quanta( value );
+			
+			systemConfig.mlfqQuanta.clear();
+			
+			while( getline( quanta, quantum, ',' ) ) {
+				
+				systemConfig.mlfqQuanta.push_back( max( 1, atoi( quantum.c_str() ) ) );
+			}
+		}
+		else if( line.compare( 0, 18, "MLFQ boost (msec):" ) == 0 ) {
+			
+			systemConfig.mlfqBoost = atol( value );
+		}
+		else if( line.compare( 0, 21, "Checkpoint file path:" ) == 0 ) {
+			
+			systemConfig.checkpointFile = line.substr( line.find_first_not_of( ' ', line.find( ':' ) + 1 ) );
+		}
+		else if( line.compare( 0, 26, "Checkpoint every (events):" ) == 0 ) {
+			
+			systemConfig.checkpointEvents = max( 0L, atol( value ) );
+		}
+		// 1 plays the simulation out in real time, 0.5 twice as fast
+		else if( line.compare( 0, 18, "Pace (time scale):" ) == 0 ) {
+			
+			systemConfig.pace = max( 0.0, atof( value ) );
+		}
+	}
+	
+	// anything but the memory types the memory manager knows about is
+	// reported & treated as fixed partitions
+	if( systemConfig.memoryType != "FIXED" && systemConfig.memoryType != "BUDDY" && systemConfig.memoryType != "PAGED" ) {
+		
+		cerr << "Error: unknown memory type \"" << systemConfig.memoryType << "\"" << endl;
+		systemConfig.memoryType = "FIXED";
+	}
+	
+	// a slice has to run at least one cycle or the jobs never get anywhere
+	if( systemConfig.quantom < 1 ) {
+		
+		cerr << "Error: quantum has to be at least 1 cycle, it is set to 1" << endl;
+		systemConfig.quantom = 1;
+	}
+	
+	if( systemConfig.memoryPartitions < 1 || systemConfig.pageSize < 1 ) {
+		
+		cerr << "Error: memory partitions & page size have to be at least 1" << endl;
+		systemConfig.memoryPartitions = max( 1, systemConfig.memoryPartitions );
+		systemConfig.pageSize = max( 1L, systemConfig.pageSize );
+	}
+	
+	// the memory manager keeps where every block starts in a long, memory
+	// too big for that is reported & left unlimited
+	if( systemConfig.memorySize < 0 || systemConfig.memorySize > MemoryManager::MAX_SIZE || 
+		systemConfig.memoryFrames < 0 || systemConfig.memoryFrames > MemoryManager::MAX_SIZE / systemConfig.pageSize ) {
 		
-		// this reads in the next process which can be the start of 
-		// another application siginifed by an A or this could be 
-		// an S which signifies the end of the metadata
-		fin >> tempOp.type;
-		fin >> dummy;
-		getline( fin, tempOp.instruction, ')' );
-		fin >> tempOp.cycleTime;
-		fin >> dummy;
+		cerr << "Error: memory has to be between 0 & " << MemoryManager::MAX_SIZE << " KB, it is left unlimited" << endl;
+		systemConfig.memorySize = 0;
+		systemConfig.memoryFrames = 0;
+	}
+	
+	// a partition can not be less than 1 KB
+	if( systemConfig.memoryType == "FIXED" && systemConfig.memorySize > 0 && systemConfig.memoryPartitions > systemConfig.memorySize ) {
+		
+		cerr << "Error: more memory partitions than KB of memory, there are " << systemConfig.memorySize << " partitions" << endl;
+		systemConfig.memoryPartitions = systemConfig.memorySize;
+	}
+	
+	// there has to be at least one thread reading the metadata
+	if( systemConfig.loaderThreads < 1 ) {
+		
+		systemConfig.loaderThreads = 1;
 	}
 	
 	fin.close();
+}
+
+bool OS::loadMetaData() {
 	
-	// if the scheduling type is not round robin, that means it is 
-	// FIFO or SJF.. so move the jobs over from a "QUEUE" to an "ARRAY"
-	// this is done because it is way eaiser to process the jobs with
-	// the array
-	if( systemConfig.processorScheduling != "Round Robin" ) {
+	if( !readMetaData() ) {
 		
-		// get the number jobs that will be processes
-		scheduler.numberOfJobs = scheduler.readyQueue.size();
+		return false;
+	}
+	
+	startJobs();
+	
+	return true;
+}
+
+bool OS::readMetaData() {
+	
+	PROFILE_PHASE( PROFILE_LOAD );
+	
+	TraceCacheHeader source;
+	
+	// an up to date cache already has every job in it
+	if( systemConfig.traceCache && cache.load( systemConfig.file, scheduler.jobs, systemConfig.devices ) ) {
 		
-		// dynamically create an array the size of the number jobs
-		// i guess a preallocated array could also be used here as well
-		scheduler.readyQueueForNonPreemptive = new Job[ scheduler.numberOfJobs ];
+		return true;
+	}
+	
+	// the cache is made for the metadata as it is before it is read
+	bool cacheable = ( systemConfig.traceCache && cache.sourceInfo( systemConfig.file, source ) );
+	
+	if( !parser.open( systemConfig.file ) ) {
+		
+		cerr << "Error: " << parser.error << endl;
+		return false;
+	}
+	
+	// the parser puts every job it reads straight into the job table,
+	// it stops at S(end) or at the first thing it could not read
+	if( !parser.readAllJobs( scheduler.jobs, systemConfig.devices, systemConfig.loaderThreads ) ) {
+		
+		cerr << "Error: " << parser.error << endl;
+		return false;
+	}
+	
+	// the next run can skip the parsing, if the cache can not be written
+	// ( like next to metadata in a read only folder ) the next run just
+	// parses again
+	if( cacheable ) {
 		
-		// move the jobs from the ready queue ( QUEUE ) into the ready 
-		//queue for non preemptive scheduling ( ARRAY )
-		for( int i = 0; i < scheduler.numberOfJobs; i++ ) {
+		cache.save( systemConfig.file, source, scheduler.jobs, systemConfig.devices );
+	}
+	
+	return true;
+}
+
+void OS::startJobs() {
+	
+	int handle;
+	vector<int> order;
+	
+	// the jobs are in the table in file order, so they get their PID
+	// in that order no matter what order they run in
+	for( handle = 0; handle < scheduler.jobs.size(); handle++ ) {
+		
+		scheduler.jobs[ handle ].PID = ++scheduler.lastPID;
+		order.push_back( handle );
+	}
+	
+	// if shortest job first, then short the jobs
+	if( systemConfig.processorScheduling == "SJF" ) {
+		
+		sortForSJF( order );
+	}
+	
+	// every job arrives at the start, in the order they should run
+	for( int i = 0; i < (int) order.size(); i++ ) {
+		
+		scheduler.admitJob( order[ i ] );
+	}
+}
+
+bool OS::streamMetaData() {
+	
+	// with an up to date cache the jobs are taken from it instead of being
+	// parsed, they still go through the stream so they arrive just the same
+	bool cached = ( systemConfig.traceCache && cache.load( systemConfig.file, cachedJobs, systemConfig.devices ) );
+	
+	if( !cached && !parser.open( systemConfig.file ) ) {
+		
+		cerr << "Error: " << parser.error << endl;
+		return false;
+	}
+	
+	// the stream holds as many jobs as can be in the system at once, the 
+	// reader waits whenever the scheduler falls that far behind
+	stream = new JobStream( systemConfig.streamWindow );
+	scheduler.stream = stream;
+	
+	reader = thread( [ this, cached ]() {
+		
+		int handle;
+		
+		if( cached ) {
 			
-			scheduler.readyQueueForNonPreemptive[ i ] = scheduler.readyQueue.front();
-			scheduler.readyQueue.pop();
+			for( handle = 0; handle < cachedJobs.size(); handle++ ) {
+				
+				stream->reserve().adopt( cachedJobs, handle );
+				stream->publish();
+			}
 		}
-	}
+		else {
+			
+			// each job is read straight into a free slot of the stream
+			while( parser.nextJob( stream->reserve(), systemConfig.devices, handle ) ) {
+				
+				stream->publish();
+			}
+		}
+		
+		stream->close();
+	} );
+	
+	// the window fills up with the first jobs, they all arrive at time 0
+	scheduler.admitJobs();
+	
+	return true;
 }
 
 // this function can be removed you do not need this, however you can 
@@ -245,126 +567,183 @@ void OS::print() {
 	
 	Operation tempOp;
 	
-	for( int i = 0; i < scheduler.numberOfJobs; i++ ) {
+	for( int i = 0; i < scheduler.jobs.size(); i++ ) {
 	
+		Job &job = scheduler.jobs[ i ];
+		
 		cout << "JOB IN POSITION #" << i + 1 << endl;
-		cout << "PID#" << scheduler.readyQueueForNonPreemptive[ i ].PID << endl;
+		cout << "PID#" << job.PID << endl;
 		
-		int count = scheduler.readyQueueForNonPreemptive[ i ].numberOfOperations;
+		int count = job.numberOfOperations;
 		
 		for( int j = 0; j < count; j++ ) {
 			
-			tempOp = scheduler.readyQueueForNonPreemptive[ i ].processes[ j ];
+			tempOp = scheduler.jobs.operations.get( job.firstOperation + j );
 			
 			cout << "PROCESS: " << tempOp.type << " INSTRUCTION: "
-				 << tempOp.instruction << " CYCLE TIME: " << tempOp.cycleTime << endl;
+				 << systemConfig.devices.name( tempOp.device ) << " CYCLE TIME: " << tempOp.cycleTime << endl;
 		}
 	
 		cout << endl;
 	}
 }
 
-// this function increments the running total of the time it takes to 
-// complete a job, the time depends on the cycle time of the operation
-// & the type of instruction that is to be excuted
-void OS::calculateTimeToProcessJob( Job &tempJob, Operation tempOp ) {
+// this function sorts the ready queue & places the shortest jobs accordingly
+// the first job we receieve needs to be processed first no matter what,
+// even if the first job is the longest.. with SJF scheduling the first 
+// job is processed while any other jobs that may come after it are 
+// sorted from shortest to longest 
+void OS::sortForSJF( vector<int> &order ) {
 	
-	if( tempOp.instruction == "run" ) {
-					
-		tempJob.timeToProcessJob += ( tempOp.cycleTime * systemConfig.processorCycleTime );
-	}
-	if( tempOp.instruction == "hard drive" ) {
+	PROFILE_PHASE( PROFILE_SORT );
+	
+	JobHeap heap;
+	
+	// every job but the first goes into a heap by its time & comes back
+	// out shortest first, only the handles are moved.. the jobs themselves
+	// stay where they are in the table & jobs just as long keep their order
+	for( int i = 1; i < (int) order.size(); i++ ) {
 		
-		tempJob.timeToProcessJob += ( tempOp.cycleTime * systemConfig.hardDriveCycleTime );
+		heap.push( order[ i ], scheduler.jobs[ order[ i ] ].timeToProcessJob );
 	}
-	if( tempOp.instruction == "keyboard" ) {
+	
+	for( int i = 1; i < (int) order.size(); i++ ) {
 		
-		tempJob.timeToProcessJob += ( tempOp.cycleTime * systemConfig.keyboardCycleTime );
+		order[ i ] = heap.pop();
 	}
-	if( tempOp.instruction == "monitor" ) {
+}
+
+// the scheduling type is only looked at here, once, the simulation for
+// that policy is then run without ever checking the type again
+void OS::simulate() {
+	
+	scheduler.setupDevices();
+	scheduler.setupCores();
+	scheduler.setupMemory();
+	scheduler.metrics.keepJobs = systemConfig.jobMetrics;
+	
+	// a resumed run keeps the trace up to the checkpoint, like the log
+	if( !systemConfig.traceFile.empty() && !scheduler.trace.open( systemConfig.traceFile, scheduler.cores.size(), systemConfig.devices,
+																  ( checkpoint.loaded() ? checkpoint.traced : -1 ) ) ) {
 		
-		tempJob.timeToProcessJob += ( tempOp.cycleTime * systemConfig.monitorDisplayTime );
+		cerr << "Error: " << systemConfig.traceFile << ": could not open trace file" << endl;
 	}
-	if( tempOp.instruction == "printer" ) {
+	
+	// a resumed run starts where the last checkpoint left off, the jobs
+	// were just read from the metadata as they were at the start
+	if( checkpoint.loaded() && !checkpoint.restore( scheduler ) ) {
 		
-		tempJob.timeToProcessJob += ( tempOp.cycleTime * systemConfig.printerCycleTime );
-	}	
-}
-
-// this function sorts the ready queue & places the shortest jobs accordingly
-// the first job we receieve needs to be processed first no matter what,
-// even if the first job is the longest.. with SJF scheduling the first 
-// job is processed while any other jobs that may come after it are 
-// sorted from shortest to longest 
-void OS::sortForSJF() {
+		cerr << "Error: " << systemConfig.checkpointFile << ": checkpoint does not match the metadata" << endl;
+		return;
+	}
 	
-	Job tempJob;
-
-	// sort for shortest job first excluding first job
-	for( int i = 1; i <= scheduler.numberOfJobs; i++ ) {
+	if( !systemConfig.checkpointFile.empty() ) {
 		
-		for( int j = 1; j < ( scheduler.numberOfJobs - 1 ); j++ ) {
+		checkpoint.every = systemConfig.checkpointEvents;
+		
+		if( !checkpoint.start( systemConfig.checkpointFile, scheduler ) ) {
 			
-			if( scheduler.readyQueueForNonPreemptive[ j + 1 ].timeToProcessJob < 
-				scheduler.readyQueueForNonPreemptive[ j ].timeToProcessJob ) {
-
-				tempJob = scheduler.readyQueueForNonPreemptive[ j ];
-				scheduler.readyQueueForNonPreemptive[ j ] = scheduler.readyQueueForNonPreemptive[ j + 1 ];
-				scheduler.readyQueueForNonPreemptive[ j + 1 ] = tempJob;
-			}
+			cerr << "Error: " << systemConfig.checkpointFile << ": could not write checkpoint file" << endl;
 		}
-	}	
-}
-
-// this simulates the processing
-void OS::simulate() {
+	}
 	
-	// this is some preprocessing stuff, you need to set the current
-	// job so the scheduler knows which job to start processing first
 	if( systemConfig.processorScheduling == "Round Robin" ) {
-			
-		scheduler.currentJob = scheduler.readyQueue.front();
-	} 
-	else
-	{
-		scheduler.currentJobIndex = 0;
-		scheduler.currentJob = scheduler.readyQueueForNonPreemptive[ scheduler.currentJobIndex ];
+		
+		simulatePolicy<RoundRobinPolicy>();
+	}
+	else if( systemConfig.processorScheduling == "SRTF" ) {
+		
+		simulatePolicy<SRTFPolicy>();
+	}
+	else if( systemConfig.processorScheduling == "SJF" ) {
+		
+		simulatePolicy<SJFPolicy>();
+	}
+	else if( systemConfig.processorScheduling == "MLFQ" ) {
+		
+		simulatePolicy<MLFQPolicy>();
+	}
+	else {
+		
+		simulatePolicy<FIFOPolicy>();
 	}
+}
 
-	// while the scheduler is not finished keep looping, while there are
-	// jobs still in the ready queue or in the wait queue
-	while( !scheduler.finished() ) {
+// this simulates the processing, the simulation jumps from one event to
+// the next.. each event is handed to the algorithm of the policy & then
+// anything that can start because of it is started
+template<class Policy>
+void OS::simulatePolicy() {
+	
+	PROFILE_PHASE( PROFILE_SIMULATE );
+	
+	Event event;
+	
+	// a resumed run is paced from where it was stopped
+	if( systemConfig.pace > 0 ) {
+		
+		scheduler.pacer.start( systemConfig.pace, scheduler.clock );
+	}
+	
+	// FIFO & SJF jobs that run one after another are worked out straight
+	// from their costs, the loop then finds nothing left to happen.. a
+	// resumed run is already part way through its events
+	if( !Policy::preemptive && !checkpoint.loaded() && scheduler.inOrder() ) {
+		
+		scheduler.computeInOrder();
+	}
+	
+	// while there is still something that is going to happen keep looping
+	while( scheduler.nextEvent( event ) ) {
+		
+		scheduler.pacer.wait( event.time );
 		
-		// if we running round robin go into this algorithm
-		if( systemConfig.processorScheduling == "Round Robin" ) {
+		if( event.type == JOB_ARRIVAL ) {
 			
-			// if the wait queue is not empty that means we need
-			// to create a thread & run the algorithm below
-			if( !scheduler.waitQueueEmpty() ) {
-				
-				scheduler.ioPreemptive();
-			}
+			scheduler.arrive<Policy>( event.handle );
+		}
+		else if( event.type == SLICE_END ) {
 			
-			// if the ready queue not empty then process the ready queue
-			if( !scheduler.readyQueueEmpty() ) {
-				
-				scheduler.RoundRobin();
-			}
+			Policy::sliceEnd( scheduler, event );
 		}
-		else
-		{
-			// if there is some IO that needs to be performed then
-			// create thread & run the algorithm below
-			if( scheduler.nonPreemptiveIO ) {
+		else {
 			
-				scheduler.ioManagement();
-			}
-			// otherwise there is not need for IO just process the next
-			// operation that needs to be handled
-			else {
+			Policy::ioComplete( scheduler, event );
+		}
+		
+		// when streaming the room left by jobs that exited goes to the next
+		// jobs right away, they arrive before anything new is started
+		scheduler.admitJobs();
+		
+		// everything that happens at the same time is handled before
+		// anything new is started, so they all get a fair shot at the cpu
+		if( !scheduler.moreEventsNow() ) {
 			
-				scheduler.nonPreemptive();
-			}
+			scheduler.dispatch<Policy>();
+			scheduler.pacer.written();
+		}
+		
+		// a checkpoint is only made between events, never part way into one
+		if( checkpoint.due() && !checkpoint.write( scheduler ) ) {
+			
+			cerr << "Error: " << systemConfig.checkpointFile << ": could not write checkpoint" << endl;
 		}
 	}
+	
+	// print to file, console or both
+	scheduler.reportUtilization();
+	
+	if( !systemConfig.metricsFile.empty() && !scheduler.reportMetrics( systemConfig.metricsFile ) ) {
+		
+		cerr << "Error: " << systemConfig.metricsFile << ": could not write metrics file" << endl;
+	}
+	
+	scheduler.stamp( LOG_SYSTEM ) << "SYSTEM - Shutdown Management" << endl;
+	
+	if( !scheduler.trace.close() ) {
+		
+		cerr << "Error: " << systemConfig.traceFile << ": could not write trace file" << endl;
+	}
+	
+	checkpoint.finish();
 }
@@ -0,0 +1,122 @@
+#include <ctime>
+
+using namespace std;
+
+// the pacer holds the simulation back so every event happens at its real
+// time, the simulated msec the config gives the devices are played out as
+// real msec times the scale.. a scale of 0.5 runs twice as fast as real
+// time & 2 half as fast.. the waits are worked out from when pacing
+// started, not from the last wait, so being late once is not carried on
+// into every wait after it.. how late the lines of every simulated time
+// were written is kept in a histogram so the jitter can be reported at
+// the end, the log writes them straight away when pacing
+class Pacer {
+	
+	public:
+		
+		// constructor, nothing is paced until it is started
+		Pacer();
+		
+		// starts pacing at the scale, the simulated time ( msec ) is now
+		void start( double, long );
+		
+		// waits until the simulated time ( msec ) is due, straight away if
+		// it is already late
+		void wait( long );
+		
+		// everything that happens at the simulated time waited for last is
+		// done & logged, how late that is goes in the lateness
+		void written();
+		
+		bool enabled() {
+			
+			return ( scale > 0 );
+		}
+		
+		double scale; // real msec every simulated msec takes, 0 if not pacing
+		Histogram lateness; // how late ( usec ) the lines of every simulated time were written
+	
+	private:
+		
+		// the end of a wait is spun instead of slept, waking up from a sleep
+		// can take longer than that
+		static const long SPIN_NSEC = 200000;
+		
+		// nsec on the monotonic clock
+		long now();
+		
+		long startTime; // when pacing started ( nsec )
+		long startClock; // simulated time pacing started at ( msec )
+		long lastTime; // simulated time last waited for, events at the same time only wait once
+		long due; // when the simulated time last waited for was due ( nsec ), -1 once it is written
+};
+
+Pacer::Pacer() {
+	
+	scale = 0;
+	startTime = 0;
+	startClock = 0;
+	lastTime = -1;
+	due = -1;
+}
+
+long Pacer::now() {
+	
+	struct timespec ts;
+	
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	
+	return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+void Pacer::start( double timeScale, long time ) {
+	
+	scale = max( 0.0, timeScale );
+	startTime = now();
+	startClock = time;
+	lastTime = -1;
+	due = -1;
+}
+
+void Pacer::wait( long time ) {
+	
+	if( !enabled() || time == lastTime ) {
+		
+		return;
+	}
+	
+	due = startTime + (long) ( ( time - startClock ) * scale * 1000000 );
+	
+	long sleepUntil = due - SPIN_NSEC;
+	
+	lastTime = time;
+	
+	// a sleep to an absolute time can be woken by a signal, like the one
+	// asking for a checkpoint, so it goes back to sleep until it is time
+	while( now() < sleepUntil ) {
+		
+		struct timespec ts;
+		
+		ts.tv_sec = sleepUntil / 1000000000L;
+		ts.tv_nsec = sleepUntil % 1000000000L;
+		
+		clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL );
+	}
+	
+	// the end of the wait is spun
+	while( now() < due ) {
+		
+		continue;
+	}
+}
+
+void Pacer::written() {
+	
+	if( !enabled() || due == -1 ) {
+		
+		return;
+	}
+	
+	lateness.add( ( now() - due ) / 1000 );
+	due = -1;
+}
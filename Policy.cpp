@@ -0,0 +1,160 @@
+#include "Scheduler.cpp"
+
+using namespace std;
+
+// a scheduling policy is a set of static functions the scheduler is built
+// with, every policy has the same ones:
+//
+//	preemptive	- true if jobs give up the cpu for io & between slices
+//	fastForward	- true if a job alone on the cpu can run quanta back to back
+//				  without going through the event queue for each of them
+//	ready		- puts a job that is ready to run on a ready queue
+//	pickNext	- takes the job a free core should run next, -1 if none
+//	sliceCycles	- how many cycles of its operation the job runs for
+//	sliceEnd	- deals with a slice ending, like the time quantom running out
+//	ioComplete	- deals with an io operation of a job completing
+//
+// a new policy only needs a struct like these & a line in OS::simulate
+
+// first in first out, a job keeps its core until it is done
+struct FIFOPolicy {
+	
+	static const bool preemptive = false;
+	static const bool fastForward = false;
+	
+	static void ready( Scheduler &scheduler, int handle ) {
+		
+		scheduler.queueOnCore( handle );
+	}
+	
+	static int pickNext( Scheduler &scheduler, int core, bool stealing ) {
+		
+		return scheduler.takeFromCore( core, stealing );
+	}
+	
+	static int sliceCycles( Scheduler &, Job &job ) {
+		
+		return job.remainingCycles;
+	}
+	
+	static void sliceEnd( Scheduler &scheduler, Event &event ) {
+		
+		scheduler.nonPreemptive( event );
+	}
+	
+	static void ioComplete( Scheduler &scheduler, Event &event ) {
+		
+		scheduler.ioManagement( event );
+	}
+};
+
+// shortest job first runs the same as FIFO, the jobs are just put in order
+// of shortest to longest before they arrive
+struct SJFPolicy : public FIFOPolicy {
+};
+
+// round robin, a job gets the time quantom & then goes to the back of the
+// ready queue
+struct RoundRobinPolicy {
+	
+	static const bool preemptive = true;
+	static const bool fastForward = true;
+	
+	static void ready( Scheduler &scheduler, int handle ) {
+		
+		scheduler.queueOnCore( handle );
+	}
+	
+	static int pickNext( Scheduler &scheduler, int core, bool stealing ) {
+		
+		return scheduler.takeFromCore( core, stealing );
+	}
+	
+	// this accounts for the scenario when you have a time quantom of say
+	// three but your operation only have two cycles left.. it will process
+	// it as much as it needs
+	static int sliceCycles( Scheduler &scheduler, Job &job ) {
+		
+		return min( job.remainingCycles, scheduler.config.quantom );
+	}
+	
+	static void sliceEnd( Scheduler &scheduler, Event &event ) {
+		
+		scheduler.RoundRobin<RoundRobinPolicy>( event );
+	}
+	
+	static void ioComplete( Scheduler &scheduler, Event &event ) {
+		
+		scheduler.ioPreemptive<RoundRobinPolicy>( event );
+	}
+};
+
+// shortest remaining time first, the job with the least work left runs &
+// a job that becomes ready with less left takes the core from a running one
+struct SRTFPolicy {
+	
+	static const bool preemptive = true;
+	static const bool fastForward = false; // a slice already runs the whole operation
+	
+	static void ready( Scheduler &scheduler, int handle ) {
+		
+		scheduler.queueByRemaining( handle );
+	}
+	
+	static int pickNext( Scheduler &scheduler, int, bool ) {
+		
+		return scheduler.takeShortest();
+	}
+	
+	// the whole operation runs unless a shorter job takes the core away
+	static int sliceCycles( Scheduler &, Job &job ) {
+		
+		return job.remainingCycles;
+	}
+	
+	static void sliceEnd( Scheduler &scheduler, Event &event ) {
+		
+		scheduler.RoundRobin<SRTFPolicy>( event );
+	}
+	
+	static void ioComplete( Scheduler &scheduler, Event &event ) {
+		
+		scheduler.ioPreemptive<SRTFPolicy>( event );
+	}
+};
+
+// multilevel feedback queue, a job runs for the quantum of its level & moves
+// down a level when it uses all of it or up a level when it comes back from
+// io.. the highest level with a job waiting always goes first
+struct MLFQPolicy {
+	
+	static const bool preemptive = true;
+	static const bool fastForward = false; // every slice can change the level of the job
+	
+	static void ready( Scheduler &scheduler, int handle ) {
+		
+		scheduler.queueByLevel( handle );
+	}
+	
+	static int pickNext( Scheduler &scheduler, int, bool ) {
+		
+		return scheduler.takeHighest();
+	}
+	
+	static int sliceCycles( Scheduler &scheduler, Job &job ) {
+		
+		return min( job.remainingCycles, scheduler.levelQuantum( job ) );
+	}
+	
+	static void sliceEnd( Scheduler &scheduler, Event &event ) {
+		
+		scheduler.demote( event );
+		scheduler.RoundRobin<MLFQPolicy>( event );
+	}
+	
+	static void ioComplete( Scheduler &scheduler, Event &event ) {
+		
+		scheduler.promote( event.handle );
+		scheduler.ioPreemptive<MLFQPolicy>( event );
+	}
+};
@@ -0,0 +1,338 @@
+// the profiler times the phases of a run & the functions the scheduler
+// spends its time in.. it is only built in when the simulator is built
+// with -DPROFILE, otherwise the PROFILE_ lines are empty & nothing of it
+// is left in the program:
+//
+//	g++ -std=c++17 -O2 -pthread -DPROFILE main.cpp -o simulator
+//	./simulator --profile
+//
+// a phase also reads the hardware counters of the cpu ( cycles,
+// instructions, cache & branch misses ) if linux lets the process open
+// them, the functions that run for every event only use the time stamp
+// counter so timing them costs next to nothing
+
+#ifdef PROFILE
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <x86intrin.h>
+#endif
+
+using namespace std;
+
+// everything the profiler keeps track of, a phase is a part of the run &
+// the rest are functions called many times within the simulation
+enum ProfileSection {
+	
+	PROFILE_CONFIGURE,		// reading the config file
+	PROFILE_LOAD,			// reading the metadata or the trace cache
+	PROFILE_SORT,			// ordering the jobs for SJF
+	PROFILE_SIMULATE,		// the event loop
+	PROFILE_LOG_WRITE,		// the log thread writing to the console & file
+	PROFILE_ROUND_ROBIN,	// a round robin or SRTF slice ending
+	PROFILE_IO_PREEMPTIVE,	// a round robin or SRTF io operation completing
+	PROFILE_NON_PREEMPTIVE,	// a FIFO or SJF slice ending
+	PROFILE_IO_MANAGEMENT,	// a FIFO or SJF io operation completing
+	PROFILE_DISPATCH,		// starting whatever can start after an event
+	PROFILE_SECTIONS
+};
+
+// the hardware counters read for every phase
+enum ProfileCounter {
+	
+	COUNTER_CYCLES,
+	COUNTER_INSTRUCTIONS,
+	COUNTER_CACHE_MISSES,
+	COUNTER_BRANCH_MISSES,
+	COUNTERS
+};
+
+class Profiler {
+	
+	public:
+		
+		// constructor & destructor
+		Profiler();
+		~Profiler();
+		
+		// starts the clock & opens the hardware counters
+		void enable();
+		
+		// time stamp counter, ticks at a steady rate on any recent x86
+		static long ticks() {
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+			return __rdtsc();
+#else
+			return chrono::duration_cast<chrono::nanoseconds>( chrono::steady_clock::now().time_since_epoch() ).count();
+#endif
+		}
+		
+		// reads the hardware counters, returns false if there are none
+		bool readCounters( long * );
+		
+		// adds a finished call of the section
+		void record( int section, long time, long allocated ) {
+			
+			calls[ section ].fetch_add( 1, memory_order_relaxed );
+			ticksSpent[ section ].fetch_add( time, memory_order_relaxed );
+			allocations[ section ].fetch_add( allocated, memory_order_relaxed );
+		}
+		
+		// adds the hardware counts of a phase
+		void recordCounters( int, long *, long * );
+		
+		// prints how long every section took
+		void report();
+		
+		bool enabled; // --profile was given
+		
+		atomic<long> allocated; // memory allocations made by the whole program so far
+	
+	private:
+		
+		atomic<long> calls[ PROFILE_SECTIONS ];
+		atomic<long> ticksSpent[ PROFILE_SECTIONS ]; // ticks spent in the section
+		atomic<long> allocations[ PROFILE_SECTIONS ];
+		long counters[ PROFILE_SECTIONS ][ COUNTERS ];
+		
+		// the ticks & wall time when profiling started, to work out how
+		// long a tick is at the end
+		long startTicks;
+		chrono::steady_clock::time_point startTime;
+		
+		int counterGroup; // descriptor of the first hardware counter, -1 if there are none
+		int counterFiles[ COUNTERS ];
+};
+
+Profiler profiler;
+
+// every allocation is counted while profiling, new is the only way the
+// simulator allocates.. these are never inlined or gcc takes the free in
+// delete for a mismatch with the new it was inlined next to
+__attribute__(( noinline )) void *operator new( size_t size ) {
+	
+	profiler.allocated.fetch_add( 1, memory_order_relaxed );
+	
+	void *memory = malloc( size == 0 ? 1 : size );
+	
+	if( memory == NULL ) {
+		
+		throw bad_alloc();
+	}
+	
+	return memory;
+}
+
+__attribute__(( noinline )) void operator delete( void *memory ) noexcept {
+	
+	free( memory );
+}
+
+__attribute__(( noinline )) void operator delete( void *memory, size_t ) noexcept {
+	
+	free( memory );
+}
+
+Profiler::Profiler() {
+	
+	enabled = false;
+	allocated = 0;
+	counterGroup = -1;
+	
+	for( int i = 0; i < PROFILE_SECTIONS; i++ ) {
+		
+		calls[ i ] = 0;
+		ticksSpent[ i ] = 0;
+		allocations[ i ] = 0;
+		memset( counters[ i ], 0, sizeof( counters[ i ] ) );
+	}
+}
+
+Profiler::~Profiler() {
+	
+	for( int i = 0; counterGroup != -1 && i < COUNTERS; i++ ) {
+		
+		close( counterFiles[ i ] );
+	}
+}
+
+void Profiler::enable() {
+	
+	unsigned long configs[ COUNTERS ] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+										  PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+	
+	enabled = true;
+	startTicks = ticks();
+	startTime = chrono::steady_clock::now();
+	
+	// the counters are opened as one group so they are read together, they
+	// only count this thread & only in user space which linux allows
+	// without any special permissions on most systems
+	for( int i = 0; i < COUNTERS; i++ ) {
+		
+		struct perf_event_attr attr;
+		
+		memset( &attr, 0, sizeof( attr ) );
+		attr.size = sizeof( attr );
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = configs[ i ];
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_GROUP;
+		
+		counterFiles[ i ] = syscall( __NR_perf_event_open, &attr, 0, -1, ( i == 0 ? -1 : counterGroup ), 0 );
+		
+		if( counterFiles[ i ] == -1 ) {
+			
+			for( int j = 0; j < i; j++ ) {
+				
+				close( counterFiles[ j ] );
+			}
+			
+			counterGroup = -1;
+			return;
+		}
+		
+		if( i == 0 ) {
+			
+			counterGroup = counterFiles[ 0 ];
+		}
+	}
+}
+
+bool Profiler::readCounters( long *values ) {
+	
+	long group[ 1 + COUNTERS ];
+	
+	if( counterGroup == -1 || read( counterGroup, group, sizeof( group ) ) != sizeof( group ) ) {
+		
+		return false;
+	}
+	
+	memcpy( values, group + 1, sizeof( long ) * COUNTERS );
+	
+	return true;
+}
+
+void Profiler::recordCounters( int section, long *before, long *after ) {
+	
+	for( int i = 0; i < COUNTERS; i++ ) {
+		
+		counters[ section ][ i ] += after[ i ] - before[ i ];
+	}
+}
+
+void Profiler::report() {
+	
+	const char *names[ PROFILE_SECTIONS ] = { "configureSystem", "loadMetaData", "sortForSJF", "simulate",
+											  "log output", "RoundRobin", "ioPreemptive", "nonPreemptive",
+											  "ioManagement", "dispatch" };
+	
+	// how many nanoseconds a tick is, measured over the whole run
+	double elapsed = chrono::duration<double, nano>( chrono::steady_clock::now() - startTime ).count();
+	double tick = elapsed / max( 1L, ticks() - startTicks );
+	
+	// the profile goes to stderr so it does not end up in the log
+	fprintf( stderr, "\n%-16s %12s %14s %14s %12s\n", "section", "calls", "total (ms)", "per call (ns)", "allocations" );
+	
+	for( int i = 0; i < PROFILE_SECTIONS; i++ ) {
+		
+		long count = calls[ i ].load();
+		
+		if( count == 0 ) {
+			
+			continue;
+		}
+		
+		fprintf( stderr, "%-16s %12ld %14.3f %14.1f %12ld\n", names[ i ], count, ticksSpent[ i ].load() * tick / 1e6,
+				 ticksSpent[ i ].load() * tick / count, allocations[ i ].load() );
+	}
+	
+	if( counterGroup == -1 ) {
+		
+		fprintf( stderr, "\nhardware counters are not available\n" );
+		return;
+	}
+	
+	fprintf( stderr, "\n%-16s %16s %16s %8s %14s %14s\n", "phase", "cycles", "instructions", "ipc", "cache misses", "branch misses" );
+	
+	// the log thread is not counted, the counters only count the thread
+	// that opened them
+	for( int i = 0; i < PROFILE_LOG_WRITE; i++ ) {
+		
+		long *c = counters[ i ];
+		
+		if( calls[ i ].load() == 0 ) {
+			
+			continue;
+		}
+		
+		fprintf( stderr, "%-16s %16ld %16ld %8.2f %14ld %14ld\n", names[ i ], c[ COUNTER_CYCLES ], c[ COUNTER_INSTRUCTIONS ],
+				 ( c[ COUNTER_CYCLES ] == 0 ? 0 : (double) c[ COUNTER_INSTRUCTIONS ] / c[ COUNTER_CYCLES ] ),
+				 c[ COUNTER_CACHE_MISSES ], c[ COUNTER_BRANCH_MISSES ] );
+	}
+}
+
+// times the block it is declared in, from where it is declared to the end
+// of the block.. a phase also reads the hardware counters
+class ProfileScope {
+	
+	public:
+		
+		ProfileScope( int scopeSection, bool scopePhase ) {
+			
+			section = scopeSection;
+			phase = scopePhase;
+			
+			if( profiler.enabled ) {
+				
+				hardware = ( phase && profiler.readCounters( before ) );
+				allocatedBefore = profiler.allocated.load( memory_order_relaxed );
+				start = Profiler::ticks();
+			}
+		}
+		
+		~ProfileScope() {
+			
+			if( profiler.enabled ) {
+				
+				long after[ COUNTERS ];
+				
+				profiler.record( section, Profiler::ticks() - start, profiler.allocated.load( memory_order_relaxed ) - allocatedBefore );
+				
+				if( hardware && profiler.readCounters( after ) ) {
+					
+					profiler.recordCounters( section, before, after );
+				}
+			}
+		}
+	
+	private:
+		
+		int section;
+		bool phase;
+		bool hardware;
+		long start;
+		long allocatedBefore;
+		long before[ COUNTERS ];
+};
+
+#define PROFILE_PHASE( section ) ProfileScope profileScope( section, true )
+#define PROFILE_SCOPE( section ) ProfileScope profileScope( section, false )
+
+#else
+
+#define PROFILE_PHASE( section )
+#define PROFILE_SCOPE( section )
+
+#endif
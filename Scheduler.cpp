@@ -1,5 +1,14 @@
-#include "Job.cpp"
+#include "JobStream.cpp"
+#include "Event.cpp"
+#include "JobHeap.cpp"
+#include "Log.cpp"
+#include "Metrics.cpp"
+#include "Trace.cpp"
+#include "Pacer.cpp"
+#include "Memory.cpp"
+#include <deque>
 #include <queue>
+#include <vector>
 
 // configure object
 struct Configure {
@@ -14,8 +23,72 @@ struct Configure {
 		
 		string processorScheduling;
 		string file;
-		string memoryType;
+		string memoryType; // FIXED, BUDDY or PAGED
 		string logType;
+		string logFile; // file the log goes to when logging to a file
+		int logLevel; // how much is logged, one of the log levels
+		string metricsFile; // file the metrics are written to at shutdown, none if empty
+		string traceFile; // file the timeline of the simulation is written to, none if empty
+		bool jobMetrics; // the metrics of every job are written out, not just the distributions
+		
+		int loaderThreads; // number of threads that read the metadata
+		int streamWindow; // most jobs in memory at once when streaming, 0 loads everything first
+		bool traceCache; // the metadata is compiled into a cache file & read from it the next time
+		
+		int processors; // number of cores the cpu has
+		bool affinity; // jobs go back to the core they last ran on
+		
+		long memorySize; // KB of main memory, 0 if it is unlimited
+		int memoryPartitions; // partitions FIXED memory is split into
+		long pageSize; // KB in a page & a frame of PAGED memory
+		long memoryFrames; // frames of PAGED memory, 0 to work them out from the memory size
+		
+		int mlfqLevels; // levels of MLFQ, each level has twice the quantum of the one above
+		vector<int> mlfqQuanta; // quantum ( cycles ) of every MLFQ level, takes the place of the levels if given
+		long mlfqBoost; // every job goes back to the top MLFQ level this often ( msec ), 0 never
+		
+		string checkpointFile; // file the simulation is checkpointed to & resumed from, none if empty
+		long checkpointEvents; // events between checkpoints, 0 only checkpoints on SIGUSR1
+		
+		double pace; // real msec every simulated msec takes when the simulation is paced, 0 runs as fast as it can
+		
+		// every device the system knows about & its cycle time, built from
+		// the cycle times above plus any devices registered in the config
+		DeviceTable devices;
+};
+
+// a core of the cpu, each core runs one job at a time & has its own queue
+// of jobs waiting to run on it, so the cores do not all share one queue
+struct Core {
+	
+	Core() {
+		
+		currentJob = -1;
+		lastJob = -1;
+		cpuBusy = false;
+		busyTime = 0;
+		slices = 0;
+		
+		sliceStart = 0;
+		sliceEnd = 0;
+		sliceCycles = 0;
+		sliceEvent = -1;
+	}
+	
+	int currentJob; // handle of the job on the core, -1 if the core is free
+	int lastJob; // handle of the job that was on the core before, -1 if the core sat idle
+	
+	bool cpuBusy; // a slice is running on the core
+	
+	deque<int> readyQueue; // jobs waiting for this core, the core takes from the front
+	
+	long busyTime; // time ( msec ) the core spent running slices
+	int slices; // number of slices the core ran
+	
+	long sliceStart; // time ( msec ) the slice running on the core started
+	long sliceEnd; // time ( msec ) the slice running on the core ends
+	int sliceCycles; // cycles the slice running on the core is for
+	long sliceEvent; // sequence of the event that ends the slice, -1 if it was cut short
 };
 
 class Scheduler {
@@ -25,432 +98,1561 @@ class Scheduler {
 		// constructor 
 		Scheduler() { 
 			
-			nonPreemptiveFinished = false;
-			preemptiveFinished = false;
-			nonPreemptiveIO = false;
+			clock = 0;
+			migrations = 0;
+			steals = 0;
+			readyJobs = 0;
+			nextCore = 0;
+			
+			jobsDone = 0;
+			turnaroundTime = 0;
+			waitingTime = 0;
+			
+			stream = NULL;
+			liveJobs = 0;
+			lastPID = 0;
+			
+			swapOuts = 0;
+			swappedTime = 0;
+			peakSwapped = 0;
+			rejectedJobs = 0;
+			memoryReleased = false;
+			
+			levelBits = 0;
+			boosts = 0;
+			nextBoost = 0;
+			demotions = 0;
+			promotions = 0;
 		}
 		
 		Configure config;
 		
-		bool readyQueueEmpty();
 		bool waitQueueEmpty();
 		
-		void moveJobToReadyQueue();
-		void moveJobToWaitQueue();
+		// makes a wait queue & free channels for every device, has to be
+		// called once the config is in place before the simulation starts
+		void setupDevices();
+		
+		// makes the cores of the cpu, has to be called once the config is in
+		// place before the simulation starts
+		void setupCores();
+		
+		// sets up the memory manager, has to be called once the config is
+		// in place before the simulation starts
+		void setupMemory();
+		
+		// prints how much of the time the cpu & each device was busy
+		void reportUtilization();
+		
+		// adds the numbers for the whole system to the metrics & writes them
+		// to the file, returns false if it could not be written
+		bool reportMetrics( string );
+		
+		// has a job in the job table arrive in the system
+		void admitJob( int );
+		
+		// takes jobs off the stream until the window is full or every job
+		// was read, waiting on the reader for any it has not read yet..
+		// returns true if any were taken
+		bool admitJobs();
+		
+		// prints the exit of the job & frees it when streaming
+		void exitJob( int );
+		
+		// gives an arriving job its memory, returns false if the job was
+		// swapped out to wait for memory or can never have enough of it
+		bool claimMemory( int );
+		
+		// brings in the jobs waiting for memory in the order they arrived,
+		// for as long as the first of them fits
+		template<class Policy> void swapIn();
+		
+		// takes the next event off the event queue & moves the clock up to
+		// it, returns false once nothing is left to happen
+		bool nextEvent( Event & );
 		
-		// round robin algorithm to deal with ready queue
-		void RoundRobin();
+		// true if another event happens at the current time
+		bool moreEventsNow();
 		
-		// FIFO or SJF algorithm to deal with ready queue
-		void nonPreemptive();
+		// everything that depends on the scheduling policy is a template on
+		// it, the policy is picked once when the simulation starts & the 
+		// code for each policy is built separately so none of it checks
+		// which policy is running.. the policies are in Policy.cpp
+		
+		// a job entering the system
+		template<class Policy> void arrive( int );
+		
+		// a job that has its memory goes to where its first operation is done
+		template<class Policy> void loadJob( int );
+		
+		// round robin & SRTF algorithm to deal with a cpu slice ending
+		template<class Policy> void RoundRobin( Event & );
+		
+		// FIFO or SJF algorithm to deal with a cpu slice ending
+		void nonPreemptive( Event & );
+		
+		// FIFO & SJF on one core run each job from start to finish before
+		// the next one gets the core, so the whole schedule is a running
+		// total of the cost of the jobs & can be worked out without any
+		// events.. only done when nothing about each slice is wanted
+		bool inOrder(); // the jobs waiting to arrive can be worked out in order
+		void computeInOrder(); // runs every job waiting to arrive, leaves the clock at the end of the last
+		
+		// a round robin job that is the only one that can run gets quantum
+		// after quantum until something else happens, these run all of them
+		// in one go instead of an event & a dispatch for every quantum
+		bool runsAlone( int ); // nothing but the job on the core can happen before the next event
+		void fastForward( int ); // runs every whole quantum of the job on the core that ends before the next event
+		
+		// starts whatever can start now that something finished, the next
+		// job on the cpu & the next io operation
+		template<class Policy> void dispatch();
 		
 		// calculates the time it took to process an operation
-		int calculateTimeToProcessOperation( Job, int );
+		long calculateTimeToProcessOperation( Job &, int );
 		
 		bool moveToNextOperationOfJob( Job & );
-		bool checkForIO( Job ); // checks to see if operation is an I or O
-		bool runCPU( Job & ); // runs cpu on the operation
-		bool finished();
-		bool nonPreemptiveFinished;
-		bool preemptiveFinished;
-		bool nonPreemptiveIO;
+		bool checkForIO( Job & ); // checks to see if operation is an I or O
+		void runCPU( Job &, int ); // runs cpu on the operation for some cycles
+		
+		// every policy goes on with a job the same way once a slice or io
+		// operation of it ends, the job only ever stops where it waits on
+		// the cpu, a device or to exit.. the rest of its progress is in the
+		// job itself so it can be checkpointed like any other job
+		int waitingOn( Job & ); // what the job waits on to go on, one of the job waits
+		int resume( Job & ); // moves the job past the operation it finished, returns what it waits on next
+		
+		template<class Policy> void requeue( int ); // sends a preempted job to where its next operation is done
+		template<class Policy> void fillCore( int, bool ); // gives a free core a job, stealing one if allowed
+		template<class Policy> void startSlice( int ); // runs the current job of the core
+		
+		// the two kinds of ready queue, a queue on every core that idle cores
+		// steal from & one heap all the cores share ordered by remaining time
+		void queueOnCore( int ); // puts the job on the ready queue of a core
+		int takeFromCore( int, bool ); // takes the next job off the ready queue of the core, -1 if none
+		bool steal( int ); // takes a waiting job from the busiest core for an idle core
+		void queueByRemaining( int ); // puts the job on the heap, it might take a core from a running job
+		int takeShortest(); // takes the job with the least work left off the heap, -1 if none
+		
+		// MLFQ keeps a queue for every level that all the cores share & takes
+		// from the highest level that has a job waiting
+		void queueByLevel( int ); // puts the job on the queue of its level
+		int takeHighest(); // takes the next job off the highest level, -1 if none
+		int levelOf( Job & ); // level of the job, it is 0 again after a boost
+		int levelQuantum( Job & ); // cycles of the quantum at the level of the job
+		void demote( Event & ); // moves the job down a level if the slice used its whole quantum
+		void promote( int ); // moves the job up a level once its io is done
+		void boostLevels(); // moves every job back to the top level
+		
+		void preemptFor( int ); // takes a core away for the job if it has less left than a running job
+		void preempt( int ); // stops the slice on the core part way through
+		bool staleSlice( Event & ); // the slice of the event was cut short, so the event means nothing
+		void continueJob( int ); // moves the FIFO or SJF job on the core on to its next operation
+		void startIO( int ); // starts the io operation of the job at the front of the devices wait queue
+		
+		void ioManagement( Event & ); // algorithm for FIFO or SJF io completing 
+		template<class Policy> void ioPreemptive( Event & ); // algorithm for round robin & SRTF io completing
+		void ioPrint( Job & ); // prints for IO operations
+		
+		// starts a line of output with the simulated time, the line is
+		// only logged if the log is set to log lines of its level
+		Log &stamp( int );
+		
+		// where the simulation prints to
+		Log log;
+		
+		int jobsDone; // jobs that exited the system
+		long turnaroundTime; // time ( msec ) from arriving to exiting, added up over every job
+		long waitingTime; // time ( msec ) jobs spent not being worked on, added up over every job
 		
-		void ioManagement(); // algorithm for FIFO or SJF wait queue 
-		void ioPreemptive(); // algorithm for round robin wait queue
-		void ioPrint( Job ); // prints for IO operations
+		Metrics metrics; // distributions of the times jobs, slices & io took
+		Trace trace; // timeline of every slice & io operation, only written if the config asks for it
+		Pacer pacer; // holds every event back until its real time, only if the config asks for it
 		
-		Job currentJob; // current job of ready queue
-		Job jobThreading; // job that is threading currently 
+		JobTable jobs; // owns every job, everything else refers to jobs by handle
+		EventQueue events; // everything that is going to happen, earliest first
 		
-		Job *readyQueueForNonPreemptive; // array used to hold ready queue for FIFO or SJF
+		long clock; // simulated time ( msec )
 		
-		int numberOfJobs;
-		int currentJobIndex; // knows which job is currently processing, used for FIFO or SJF
-		int timeQuantom;
+		vector<Core> cores; // every core of the cpu
 		
-		queue<Job> readyQueue; // used for round robin
-		queue<Job> waitQueue; // used for round robin
+		long migrations; // times a job ran on a different core than last time
+		long steals; // times an idle core took a job from another core
+		
+		int readyJobs; // jobs waiting on the ready queues of all the cores
+		int nextCore; // core the search for the least loaded core starts at
+		
+		// SRTF jobs waiting for a core, every core shares it & takes the job
+		// with the least remaining time
+		JobHeap readyHeap;
+		
+		// MLFQ jobs waiting for a core, a queue for every level & a bit for
+		// every level that has a job waiting.. the lowest bit that is set is
+		// the highest level with a job
+		vector< deque<int> > levelQueues;
+		vector<int> levelQuanta; // quantum ( cycles ) of every level
+		static const long MAX_LEVEL_QUANTUM = 1L << 30; // the doubling stops here so a quantum still fits in an int
+		unsigned long levelBits;
+		
+		long boosts; // times every job was moved back to the top level
+		long nextBoost; // time ( msec ) of the next boost
+		long demotions; // times a job moved down a level
+		long promotions; // times a job moved up a level
+		
+		JobStream *stream; // jobs still being read in when streaming, otherwise NULL
+		
+		int liveJobs; // jobs that entered the system & have not exited yet
+		int lastPID; // PID given to the last job that entered the system
+		
+		
+		// each device has its own wait queue & number of channels, so a job
+		// waiting on the keyboard does not hold up a job that wants the hard
+		// drive.. all of these are indexed by device id
+		vector< queue<int> > waitQueues; // jobs waiting to do io on the device
+		vector<int> busyChannels; // channels of the device doing io right now
+		
+		vector<long> deviceTime; // time ( msec ) each device spent doing io
+		
+		MemoryManager memory; // main memory, jobs only get on the ready queue once they have some
+		
+		// jobs that arrived when there was not enough memory free wait here
+		// swapped out, the first to arrive is the first to be swapped in
+		queue<int> swapQueue;
+		
+		long swapOuts; // jobs that had to wait for memory
+		long swappedTime; // time ( msec ) jobs spent swapped out, added up over every job
+		int peakSwapped; // most jobs swapped out at once
+		long rejectedJobs; // jobs that needed more memory than there is
+		bool memoryReleased; // memory was given back since the swapped out jobs were last looked at
 };
 
-// if the jobs operation is not finished then it can decrement the cycle
-// time by one, other wise it returns false because the operation is complete
-bool Scheduler::runCPU( Job &job ) {
-	
-	if( job.processes[ job.currentOperation ].cycleTime != 0 ) {
-
-		job.processes[ job.currentOperation ].cycleTime--;
-		return true;
-	}
-
-	return false;
-}
-
-bool Scheduler::readyQueueEmpty() {
+// runs the jobs operation for the given number of cycles in one step, 
+// there is no need to go one cycle at a time since nothing can happen
+// to the job in between
+void Scheduler::runCPU( Job &job, int cycles ) {
 	
-	return( readyQueue.empty() );
+	job.remainingCycles -= cycles;
+	job.remainingTime -= calculateTimeToProcessOperation( job, cycles );
 }
 
 bool Scheduler::waitQueueEmpty() {
 	
-	return( waitQueue.empty() );
-}
-
-// use these wisely as they only move the "currentJob" object to the 
-// ready or wait queue, has no effect on "jobThreading" object
-void Scheduler::moveJobToReadyQueue() {
+	for( int device = 0; device < (int) waitQueues.size(); device++ ) {
+		
+		if( !waitQueues[ device ].empty() ) {
+			
+			return false;
+		}
+	}
 	
-	readyQueue.push( currentJob );
+	return true;
 }
 
-void Scheduler::moveJobToWaitQueue() {
+void Scheduler::setupDevices() {
 	
-	waitQueue.push( currentJob );
-}
-
-bool Scheduler::finished() {
+	int count = config.devices.size();
 	
-	return ( nonPreemptiveFinished || preemptiveFinished );
+	waitQueues.assign( count, queue<int>() );
+	busyChannels.assign( count, 0 );
+	deviceTime.assign( count, 0 );
 }
 
-// if the job is not finished then move to the next operation to be 
-// processed, if you can't move to the next job that means that the 
-// job is done since there are no more operations it needs to process
-bool Scheduler::moveToNextOperationOfJob( Job &job ) {
+void Scheduler::setupCores() {
 	
-	if( !job.jobFinished() ) {
-		
-		job.currentOperation++;
-		return true;
-	}
+	cores.assign( max( 1, config.processors ), Core() );
 	
-	return false;
-}
-
-// checks for I or O 
-bool Scheduler::checkForIO( Job job ) {
-
-	if( job.processes[ job.currentOperation ].type == 'I' || 
-		job.processes[ job.currentOperation ].type == 'O' ) {
+	// the MLFQ levels double the quantum all the way down unless the
+	// config gives the quantum of every level, there can be at most 64
+	// levels so every level has a bit.. the doubling is done in a long &
+	// capped, a big quantum would run over an int after a few levels
+	long most = MAX_LEVEL_QUANTUM;
+	long quantum = min( max( 1L, (long) config.quantom ), most );
+	
+	levelQuanta = config.mlfqQuanta;
+	
+	for( int i = 0; config.mlfqQuanta.empty() && i < config.mlfqLevels; i++ ) {
 		
-		return true;
+		levelQuanta.push_back( (int) min( quantum << min( i, 20 ), most ) );
 	}
 	
-	return false;
+	levelQuanta.resize( min( max( 1, (int) levelQuanta.size() ), 64 ), (int) quantum );
+	levelQueues.assign( levelQuanta.size(), deque<int>() );
+	levelBits = 0;
+	nextBoost = config.mlfqBoost;
 }
 
-// used to print for io operation, make sure it does console, file or both
-void Scheduler::ioPrint( Job job ) {
+void Scheduler::setupMemory() {
 	
-	cout << "  - ";
+	int type = MEMORY_FIXED;
+	long size = config.memorySize;
 	
-	if( job.processes[ job.currentOperation ].type == 'I' ) {
+	if( config.memoryType == "BUDDY" ) {
 		
-		cout << "Input, ";
+		type = MEMORY_BUDDY;
 	}
-	else {
+	else if( config.memoryType == "PAGED" ) {
 		
-		cout << "Output, ";
+		type = MEMORY_PAGED;
+		
+		// the frame count takes the place of the memory size if it is given
+		if( config.memoryFrames > 0 ) {
+			
+			size = config.memoryFrames * config.pageSize;
+		}
 	}
 	
-	cout << job.processes[ job.currentOperation ].instruction;
+	memory = MemoryManager();
+	memory.setup( type, size, config.memoryPartitions, config.pageSize );
 }
 
-// FIFO or SJF io management
-void Scheduler::ioManagement() {
+void Scheduler::reportUtilization() {
 	
-	// print to console, file or both
-	cout << "PID " << currentJob.PID;
-	ioPrint( currentJob ); 
-	cout << " started" << endl;
-		 
-	cout << "PID " << currentJob.PID;
-	ioPrint( currentJob ); 
-	cout << " completed ( " 
-		 << calculateTimeToProcessOperation( currentJob, currentJob.processes[ currentJob.currentOperation ].cycleTime ) 
-		 << " mSec )" << endl;     
-	
-	// run down the cycle time to 0
-	while( runCPU( currentJob ) );
-	
-	// if you can move to next operation then do it, if this fails
-	// that means the job is done & can be removed from the ready queue
-	if( moveToNextOperationOfJob( currentJob ) ) {
-		
-		// if the job still has operations needed to be processed then
-		// we come in here, if the next operation is also IO then manage
-		// IO by creating another thread & process job
-		if( checkForIO( currentJob ) ) {
-			
-			cout << "SYSTEM - Managing I/O ( TIME )" << endl;
-			nonPreemptiveIO = true;
-		}
-		// other wise no need to create a thread we can process ready queue
-		else {
-			
-			nonPreemptiveIO = false;
-		}
-	}
-	// else the job is finished & can go to the next job to process
-	else {
-			
-		// print to console, file or both
-		cout << "PID " << currentJob.PID << "  - Exit System" << endl;
-		cout << "SYSTEM - Ending Process ( TIME )" << endl;
+	long cpuTime = 0;
+	long busiest = 0;
+	
+	// nothing ran so there is nothing to report
+	if( clock == 0 ) {
 		
-		// go to next job to process
-		currentJobIndex++;
+		return;
+	}
+	
+	for( int i = 0; i < (int) cores.size(); i++ ) {
 		
-		// if that was the last job then shut down the program
-		if( currentJobIndex == numberOfJobs ) {
+		cpuTime += cores[ i ].busyTime;
+		busiest = max( busiest, cores[ i ].busyTime );
 		
-			cout << "SYSTEM - Shutdown Management" << endl;
-			nonPreemptiveFinished = true;
-		}
-		else{
+		if( cores.size() > 1 ) {
 			
-			// other wise process the next job on ready queue
-			currentJob = readyQueueForNonPreemptive[ currentJobIndex ];
+			stamp( LOG_SYSTEM ) << "SYSTEM - core " << i << " utilization " << 100.0 * cores[ i ].busyTime / clock 
+								<< "% ( " << cores[ i ].slices << " slices )" << endl;
 		}
-	}	
-}
-
-void Scheduler::ioPreemptive() {
+	}
 	
-	// get the front of the ready queue
-	jobThreading = waitQueue.front();
+	stamp( LOG_SYSTEM ) << "SYSTEM - CPU utilization " << 100.0 * cpuTime / ( (double) clock * cores.size() ) << "%" << endl;
 	
-	// print to console, file or both
-	cout << "PID " << jobThreading.PID;
-	ioPrint( jobThreading ); 
-	cout << " started" << endl;
-	
-	cout << "PID " << jobThreading.PID;
-	ioPrint( jobThreading ); 
-	cout << " completed ( " 
-		 << calculateTimeToProcessOperation( jobThreading, jobThreading.processes[ jobThreading.currentOperation ].cycleTime ) 
-		 << " mSec )" << endl;
-	
-	// run the cpu cycle time down to 0	 
-	while( runCPU( jobThreading ) );
-
-	// if the job that is threading has next operation then move to it
-	// if this fails then remove from wait queue
-	if( moveToNextOperationOfJob( jobThreading ) ) {
-		
-		// if the job still has operations it needs to complete then check for
-		// IO, if the next operation is IO then put it wait on the wait queue
-		if( checkForIO( jobThreading ) ) {
-			
-			cout << "SYSTEM - Managing I/O ( TIME )" << endl;
-			waitQueue.pop();
-			waitQueue.push( jobThreading );
-		}
-		else {
+	// load imbalance is how much longer the busiest core worked than the 
+	// average core, 1.0 means the work was spread out perfectly
+	if( cores.size() > 1 && cpuTime > 0 ) {
+		
+		log.digits = 2;
+		stamp( LOG_SYSTEM ) << "SYSTEM - " << migrations << " migrations, " << steals << " steals, load imbalance " 
+							<< (double) busiest * cores.size() / cpuTime << endl;
+		log.digits = 1;
+	}
+	
+	// a device with more than one channel can be busy for more than the 
+	// whole run, so it is measured against all of its channels
+	for( int device = DeviceTable::RUN + 1; device < (int) deviceTime.size(); device++ ) {
+		
+		if( deviceTime[ device ] == 0 ) {
 			
-			// otherwise pop it off the wait queue & send it back to the ready queue
-			waitQueue.pop();
-			readyQueue.push( jobThreading );
+			continue;
 		}
+		
+		stamp( LOG_SYSTEM ) << "SYSTEM - " << config.devices.name( device ) << " utilization " 
+							<< 100.0 * deviceTime[ device ] / ( (double) clock * config.devices.channelCount( device ) ) 
+							<< "% ( " << config.devices.channelCount( device ) << " channel" 
+							<< ( config.devices.channelCount( device ) == 1 ? "" : "s" ) << " )" << endl;
+	}
+	
+	if( config.processorScheduling == "MLFQ" ) {
+		
+		stamp( LOG_SYSTEM ) << "SYSTEM - MLFQ " << (int) levelQuanta.size() << " levels, " << demotions << " demotions, " 
+							<< promotions << " promotions, " << boosts << " boosts" << endl;
 	}
-	// otherwise the job is finished 
-	else {
 	
-		// print to console, file or both
-		cout << "PID " << currentJob.PID << "  - Exit System" << endl;
-		cout << "SYSTEM - Ending Process ( TIME )" << endl;
+	// internal fragmentation is memory given to jobs that they did not ask
+	// for, like the rest of a partition or the last page
+	if( memory.managed() ) {
 		
-		// take it off the wait queue
-		waitQueue.pop();
+		stamp( LOG_SYSTEM ) << "SYSTEM - " << memory.typeName() << " memory peak use " << 100.0 * memory.peakInUse / memory.size 
+							<< "% of " << memory.size << " KB, internal fragmentation " 
+							<< ( memory.given == 0 ? 0 : 100.0 * ( memory.given - memory.requested ) / memory.given ) << "%" << endl;
 		
-		// if both the ready queue & wait queue are empty then shutdown
-		if( readyQueue.empty() && waitQueue.empty() ) {
-			
-			cout << "SYSTEM - Shutdown Management" << endl;
-			preemptiveFinished = true;
-		}
+		stamp( LOG_SYSTEM ) << "SYSTEM - " << memory.failures << " allocation failures ( " << memory.fragmentedFailures 
+							<< " with enough memory free but not in one piece ), " << swapOuts << " jobs swapped out ( at most " 
+							<< peakSwapped << " at once, " << ( swapOuts == 0 ? 0 : (double) swappedTime / swapOuts ) 
+							<< " mSec each ), " << rejectedJobs << " rejected" << endl;
+	}
+	
+	// how late the events happened against when they were due, in uSec
+	if( pacer.enabled() ) {
+		
+		log.digits = 2;
+		stamp( LOG_SYSTEM ) << "SYSTEM - paced at " << pacer.scale << " mSec per mSec, " << pacer.lateness.count 
+							<< " times late by p50 " << pacer.lateness.percentile( 0.5 ) << " uSec, p99 " 
+							<< pacer.lateness.percentile( 0.99 ) << " uSec, max " << pacer.lateness.largest << " uSec" << endl;
+		log.digits = 1;
 	}
 }
 
-// calculate the time it takes to process an operation
-int Scheduler::calculateTimeToProcessOperation( Job job, int cycleTime ) {
+bool Scheduler::reportMetrics( string filename ) {
+	
+	long cpuTime = 0;
+	
+	for( int i = 0; i < (int) cores.size(); i++ ) {
+		
+		cpuTime += cores[ i ].busyTime;
+	}
 	
-	if( job.processes[ job.currentOperation ].instruction == "run" ) {
-					
-		return ( cycleTime * config.processorCycleTime );
+	metrics.system( "finish_time", clock );
+	metrics.system( "jobs", jobsDone );
+	metrics.system( "throughput", ( clock == 0 ? 0 : 1000.0 * jobsDone / clock ) );
+	metrics.system( "cpu_utilization", ( clock == 0 ? 0 : 100.0 * cpuTime / ( (double) clock * cores.size() ) ) );
+	
+	for( int i = 0; i < (int) cores.size() && cores.size() > 1; i++ ) {
+		
+		metrics.system( "core_" + to_string( i ) + "_utilization", ( clock == 0 ? 0 : 100.0 * cores[ i ].busyTime / clock ) );
 	}
-	if( job.processes[ job.currentOperation ].instruction == "hard drive" ) {
+	
+	// the names of devices can have spaces, like hard drive
+	for( int device = DeviceTable::RUN + 1; device < (int) deviceTime.size(); device++ ) {
+		
+		string name = config.devices.name( device );
 		
-		return ( cycleTime * config.hardDriveCycleTime );
+		replace( name.begin(), name.end(), ' ', '_' );
+		metrics.system( name + "_utilization", ( clock == 0 ? 0 : 100.0 * deviceTime[ device ] / 
+												 ( (double) clock * config.devices.channelCount( device ) ) ) );
 	}
-	if( job.processes[ job.currentOperation ].instruction == "keyboard" ) {
+	
+	if( config.processorScheduling == "MLFQ" ) {
 		
-		return ( cycleTime * config.keyboardCycleTime );
+		metrics.system( "mlfq_demotions", demotions );
+		metrics.system( "mlfq_promotions", promotions );
+		metrics.system( "mlfq_boosts", boosts );
 	}
-	if( job.processes[ job.currentOperation ].instruction == "monitor" ) {
+	
+	if( memory.managed() ) {
 		
-		return ( cycleTime * config.monitorDisplayTime );
+		metrics.system( "memory_peak_utilization", 100.0 * memory.peakInUse / memory.size );
+		metrics.system( "memory_internal_fragmentation", ( memory.given == 0 ? 0 : 100.0 * ( memory.given - memory.requested ) / memory.given ) );
+		metrics.system( "memory_allocation_failures", memory.failures );
+		metrics.system( "memory_fragmented_failures", memory.fragmentedFailures );
+		metrics.system( "memory_swap_outs", swapOuts );
+		metrics.system( "memory_swap_time", ( swapOuts == 0 ? 0 : (double) swappedTime / swapOuts ) );
+		metrics.system( "memory_peak_swapped", peakSwapped );
+		metrics.system( "memory_rejected_jobs", rejectedJobs );
 	}
-	if( job.processes[ job.currentOperation ].instruction == "printer" ) {
+	
+	if( pacer.enabled() ) {
 		
-		return ( cycleTime * config.printerCycleTime );
-	}	
+		metrics.system( "pace_scale", pacer.scale );
+		metrics.system( "pace_lateness_p50_usec", pacer.lateness.percentile( 0.5 ) );
+		metrics.system( "pace_lateness_p99_usec", pacer.lateness.percentile( 0.99 ) );
+		metrics.system( "pace_lateness_max_usec", pacer.lateness.largest );
+	}
 	
-	return -1;
+	return metrics.write( filename );
 }
 
-// FIFO or SJF ready queue algorithm, both use the same algorithm
-// the SJF is already sorted so we can just process all the jobs
-void Scheduler::nonPreemptive() {
+Log &Scheduler::stamp( int level ) {
 	
-	// print to console, file or both 
-	cout << "PID " << currentJob.PID << "  - Processing " 
-		 << currentJob.processes[ currentJob.currentOperation ].instruction 
-		 << " ( " << calculateTimeToProcessOperation( currentJob, currentJob.processes[ currentJob.currentOperation ].cycleTime ) 
-		 << " mSec )" << endl;
+	return ( log.line( level ) << clock << " mSec - " );
+}
+
+void Scheduler::admitJob( int handle ) {
 	
-	// process the operation
-	while( runCPU( currentJob ) );
+	liveJobs++;
+	
+	// the job arrives right now, every job that is loaded before the 
+	// simulation starts arrives at time 0
+	events.schedule( clock, JOB_ARRIVAL, handle, 0 );
+}
 
-	// if you can move to the next operation then do it, otherwise the
-	// job is finished & the next job should be processed
-	if( moveToNextOperationOfJob( currentJob ) ) {
+bool Scheduler::admitJobs() {
+	
+	JobTable *slot;
+	bool admitted = false;
+	
+	if( stream == NULL ) {
+		
+		return false;
+	}
+	
+	// only let as many jobs in as the window allows, the rest wait in
+	// the stream & the reader waits once the stream is full.. a job the
+	// reader has not got to yet is waited for, so when a job arrives only
+	// depends on the metadata & the window & never on how fast it is read
+	while( liveJobs < config.streamWindow && !stream->drained() ) {
 		
-		// check for IO, if the operation is IO then it will start a thread
-		if( checkForIO( currentJob ) ) {
+		if( ( slot = stream->front() ) == NULL ) {
 			
-			cout << "SYSTEM - Managing I/O ( TIME )" << endl;
-			nonPreemptiveIO = true;
+			this_thread::yield();
+			continue;
 		}
+		
+		int handle = jobs.adopt( *slot, 0 );
+		
+		// jobs come off the stream in file order so they get their PID now
+		jobs[ handle ].PID = ++lastPID;
+		admitJob( handle );
+		stream->release();
+		admitted = true;
 	}
-	// otherwise the job is done 
-	else {
-			
-		// print to console, file or both
-		cout << "PID " << currentJob.PID << "  - Exit System" << endl;
-		cout << "SYSTEM - Ending Process ( TIME )" << endl;
+	
+	return admitted;
+}
+
+void Scheduler::exitJob( int handle ) {
+	
+	Job &job = jobs[ handle ];
+	
+	// print to console, file or both
+	stamp( LOG_JOBS ) << "PID " << job.PID << "  - Exit System" << endl;
+	stamp( LOG_JOBS ) << "SYSTEM - Ending Process" << endl;
+	
+	// any time the job was in the system but not on a core or device it
+	// was waiting in some queue.. a job rejected for its memory did none
+	// of its work
+	long serviceTime = job.timeToProcessJob - job.remainingTime;
+	
+	jobsDone++;
+	turnaroundTime += clock - job.arrivalTime;
+	waitingTime += clock - job.arrivalTime - serviceTime;
+	
+	// a job with no operations never started, it is done as soon as it arrives
+	metrics.exit( job.PID, job.arrivalTime, ( job.startTime == -1 ? clock : job.startTime ), clock, serviceTime );
+	
+	if( trace.enabled() ) {
 		
-		// move to the next job on the ready queue
-		currentJobIndex++;
+		trace.job( job.PID, job.arrivalTime, clock );
+	}
+	
+	if( job.memoryBlock != -1 ) {
 		
-		// if all the jobs have been processed then shutdown
-		if( currentJobIndex == numberOfJobs ) {
+		memory.release( job.memoryBlock, job.memory );
+		job.memoryBlock = -1;
+		memoryReleased = true;
+	}
+	
+	liveJobs--;
+	
+	// when streaming the job's memory is reused for jobs still coming in,
+	// otherwise the whole trace is in memory anyway
+	if( stream != NULL ) {
 		
-			cout << "SYSTEM - Shutdown Management ( TIME )" << endl;
-			nonPreemptiveFinished = true;
-		}
-		else{
-			
-			// other wise start processing the next job
-			currentJob = readyQueueForNonPreemptive[ currentJobIndex ];
-		}
-	}	
+		jobs.releaseJob( handle );
+	}
 }
 
-// round robin scheduling algorithm
-void Scheduler::RoundRobin() {
+bool Scheduler::claimMemory( int handle ) {
 	
-	// get time quantom
-	timeQuantom = config.quantom;
-	int time = 0; // this is how much time has "passed"
+	Job &job = jobs[ handle ];
 	
-	if( !currentJob.jobFinished() ) {
+	// a job that needs no memory goes straight in, so does every job when
+	// the memory is unlimited
+	if( job.memory == 0 || !memory.managed() ) {
 		
-		// run the operation one time cycle & increment the time
-		runCPU( currentJob );
-		time++;
+		return true;
+	}
+	
+	// waiting would not help a job that needs more than the whole memory,
+	// it leaves the system without running
+	if( !memory.fits( job.memory ) ) {
 		
-		// if the current jobs operation isn't finished & the time 
-		// quantom isn't reached then keep processing.. this accounts for
-		// the scenario when you have a time quantom of say three but your
-		// operation only have two cycles left.. it will process it as much 
-		// as it needs
-		while( !currentJob.operationFinished() && ( time < timeQuantom ) ) {
-			
-			runCPU( currentJob ); 
-			time++;
-		}
+		stamp( LOG_JOBS ) << "PID " << job.PID << "  - Rejected, needs " << job.memory << " KB of memory" << endl;
+		rejectedJobs++;
+		exitJob( handle );
 		
-		// print to console, file or both.. here the "time" variable is 
-		// sent into the calculateTime function because it only prints
-		// how many every cycle we got through, this could be as much
-		// as the time quantom or less depending on how many cycles 
-		// were left on the jobs operations
-		cout << "PID " << currentJob.PID << "  - Processing " 
-	         << currentJob.processes[ currentJob.currentOperation ].instruction 
-	         << " ( " << calculateTimeToProcessOperation( currentJob, time ) << " mSec )" << endl;		
-	
-		// if jobs operation is finished then move to next operation,
-		// other wise the jobs operation still needs processing
-		if( currentJob.operationFinished() ) {
-			
-			// if the job still has more operations then move to the next one
-			if( moveToNextOperationOfJob( currentJob ) ) {
-				
-				// if the operation is IO then take the job off the
-				// ready queue & put it on the wait queue
-				if( checkForIO( currentJob ) ) {
-					
-					cout << "SYSTEM - Managing I/O ( TIME )" << endl;
-					readyQueue.pop();
-					waitQueue.push( currentJob );
-					
-					// if the ready queue isn't empty then get the next job
-					// on the ready queue & make it the currentJob
-					if( !readyQueueEmpty() ) {
-					
-						cout << "SYSTEM - Swapping Processes ( TIME )" << endl;
-						currentJob = readyQueue.front();
-					}
-				}
-				// other wise the next operation is not IO so place it
-				// back onto the ready queue & process the job at the
-				// front of the ready queue
-				else {
-					
-					cout << "SYSTEM - Swapping Processes ( TIME )" << endl;
-					readyQueue.pop();
-					moveJobToReadyQueue();
-					currentJob = readyQueue.front();
-				}
-			}
-		}
-		// other wise the jobs operation is not finsihed & still needs
-		// to be processed, so place it back onto the ready queue & 
-		// process the job at the front of the ready queue
-		else {
-			
-			cout << "SYSTEM - Swapping Processes ( TIME )" << endl;
-			readyQueue.pop();
-			moveJobToReadyQueue();
-			currentJob = readyQueue.front();
-		}
+		return false;
 	}
-	// other wise the current job is finsished 
-	else {
+	
+	// jobs already waiting for memory go first, even if this one would fit
+	if( swapQueue.empty() && ( job.memoryBlock = memory.allocate( job.memory ) ) != -1 ) {
+		
+		stamp( LOG_ALL ) << "SYSTEM - Allocating " << job.memory << " KB for PID " << job.PID << endl;
+		return true;
+	}
+	
+	// a job is counted once when it has to wait, the tries to swap it in
+	// later are not counted again
+	memory.failed( job.memory );
+	
+	stamp( LOG_ALL ) << "SYSTEM - Swapping out PID " << job.PID << ", waiting for memory" << endl;
+	
+	swapQueue.push( handle );
+	swapOuts++;
+	peakSwapped = max( peakSwapped, (int) swapQueue.size() );
+	
+	return false;
+}
+
+template<class Policy>
+void Scheduler::swapIn() {
+	
+	// memory only frees up when a job exits, until then the first job
+	// waiting would not fit any better than it did last time
+	if( !memoryReleased ) {
 		
-		// print to console, file or both
-		cout << "PID " << currentJob.PID << "  - Exit System" << endl;
-		cout << "SYSTEM - Ending Process ( TIME )" << endl;
+		return;
+	}
+	
+	memoryReleased = false;
+	
+	while( !swapQueue.empty() ) {
 		
-		// take the current job off the ready queue
-		readyQueue.pop();
+		int handle = swapQueue.front();
+		Job &job = jobs[ handle ];
 		
-		// if the ready queue & the wait queue is finsihed then we done
-		if( readyQueue.empty() && waitQueue.empty() ) {
+		if( ( job.memoryBlock = memory.allocate( job.memory ) ) == -1 ) {
 			
-			cout << "SYSTEM - Shutdown Management" << endl;
-			preemptiveFinished = true;
-		}
-		// otherwise if the ready queue is not empty, then process the
-		// the front of the ready queue
-		else {
-			
-			if( !readyQueueEmpty() ) {
-					
-				cout << "SYSTEM - Swapping Processes ( TIME )" << endl;
-				currentJob = readyQueue.front();
-			}
+			break;
 		}
-	}	
+		
+		swapQueue.pop();
+		
+		// jobs are only ever swapped out when they arrive
+		swappedTime += clock - job.arrivalTime;
+		
+		stamp( LOG_ALL ) << "SYSTEM - Swapping in PID " << job.PID << ", allocating " << job.memory << " KB" << endl;
+		
+		loadJob<Policy>( handle );
+	}
+}
+
+bool Scheduler::moreEventsNow() {
+	
+	return ( !events.empty() && events.nextTime() == clock );
+}
+
+bool Scheduler::nextEvent( Event &event ) {
+	
+	// nothing is going on, but jobs might still be coming in
+	if( events.empty() ) {
+		
+		admitJobs();
+	}
+	
+	if( events.empty() ) {
+		
+		return false;
+	}
+	
+	// jump straight to the next thing that happens, nothing changes in
+	// between so there is no need to step through the time in between
+	event = events.next();
+	clock = event.time;
+	
+	return true;
+}
+
+// if the job is not finished then move to the next operation to be 
+// processed, if you can't move to the next job that means that the 
+// job is done since there are no more operations it needs to process..
+// moving past the last operation also counts as done, otherwise the 
+// caller would go on to look at an operation that does not exist
+bool Scheduler::moveToNextOperationOfJob( Job &job ) {
+	
+	if( !job.jobFinished() ) {
+		
+		jobs.nextOperation( job );
+		return !job.jobFinished();
+	}
+	
+	return false;
+}
+
+// checks for I or O 
+bool Scheduler::checkForIO( Job &job ) {
+
+	char type = jobs.type( job );
+	
+	if( type == 'I' || type == 'O' ) {
+		
+		return true;
+	}
+	
+	return false;
+}
+
+int Scheduler::waitingOn( Job &job ) {
+	
+	if( job.jobFinished() ) {
+		
+		return WAIT_EXIT;
+	}
+	
+	return ( checkForIO( job ) ? WAIT_IO : WAIT_CPU );
 }
 
+// an operation that still has cycles left is carried on the next time
+// the job gets a core
+int Scheduler::resume( Job &job ) {
+	
+	if( job.operationFinished() ) {
+		
+		moveToNextOperationOfJob( job );
+	}
+	
+	return waitingOn( job );
+}
+
+// used to print for io operation, make sure it does console, file or both
+void Scheduler::ioPrint( Job &job ) {
+	
+	log << "  - ";
+	
+	if( jobs.type( job ) == 'I' ) {
+		
+		log << "Input, ";
+	}
+	else {
+		
+		log << "Output, ";
+	}
+	
+	log << config.devices.name( jobs.device( job ) );
+}
+
+// calculate the time it takes to process an operation, the device id
+// indexes straight into the cost table
+long Scheduler::calculateTimeToProcessOperation( Job &job, int cycleTime ) {
+	
+	return config.devices.cost( jobs.device( job ), cycleTime );
+}
+
+template<class Policy>
+void Scheduler::arrive( int handle ) {
+	
+	jobs[ handle ].arrivalTime = clock;
+	jobs[ handle ].remainingTime = jobs[ handle ].timeToProcessJob;
+	
+	// print to file, console or both
+	stamp( LOG_JOBS ) << "PID " << jobs[ handle ].PID << "  - Enter System" << endl;
+	stamp( LOG_JOBS ) << "SYSTEM - Creating PID " << jobs[ handle ].PID << endl;
+	
+	// a job that can not have its memory yet waits swapped out
+	if( claimMemory( handle ) ) {
+		
+		loadJob<Policy>( handle );
+	}
+}
+
+template<class Policy>
+void Scheduler::loadJob( int handle ) {
+	
+	// round robin & SRTF jobs go wherever their first operation is done,
+	// FIFO & SJF jobs wait their turn on the ready queue no matter what
+	if( Policy::preemptive ) {
+		
+		requeue<Policy>( handle );
+	}
+	else {
+		
+		Policy::ready( *this, handle );
+	}
+}
+
+template<class Policy>
+void Scheduler::requeue( int handle ) {
+	
+	Job &job = jobs[ handle ];
+	int wait = waitingOn( job );
+	
+	if( wait == WAIT_EXIT ) {
+		
+		exitJob( handle );
+	}
+	// if the operation is IO then put the job on the wait queue
+	else if( wait == WAIT_IO ) {
+		
+		stamp( LOG_ALL ) << "SYSTEM - Managing I/O" << endl;
+		waitQueues[ jobs.device( job ) ].push( handle );
+	}
+	// other wise it goes to the back of a ready queue
+	else {
+		
+		Policy::ready( *this, handle );
+	}
+}
+
+bool Scheduler::inOrder() {
+	
+	// every slice & io is only logged or traced by the simulation, more
+	// than one core or limited memory & the jobs overlap
+	return ( cores.size() == 1 && log.level <= LOG_SYSTEM && !trace.enabled() && !memory.managed() && stream == NULL && !pacer.enabled() );
+}
+
+void Scheduler::computeInOrder() {
+	
+	static const int COUNTED_CYCLES = 1024; // slices & io of fewer cycles are counted up before going in the histograms
+	
+	OperationTable &table = jobs.ops();
+	Core &core = cores[ 0 ];
+	int deviceCount = config.devices.size();
+	vector<long> counts( deviceCount * COUNTED_CYCLES, 0 );
+	
+	// the slices & io operations come out the same whatever order the jobs
+	// run in, so they are gone through in one pass over the operations..
+	// most of them are only a few cycles, so how many there are of each
+	// is counted & the histograms get every one of the same size at once
+	for( int i = 0; i < table.size(); i++ ) {
+		
+		int device = table.device( i );
+		int cycles = table.cycles( i );
+		
+		if( cycles >= 0 && cycles < COUNTED_CYCLES ) {
+			
+			counts[ device * COUNTED_CYCLES + cycles ]++;
+		}
+		else if( device == DeviceTable::RUN ) {
+			
+			metrics.slice( config.devices.cost( device, cycles ) );
+		}
+		else {
+			
+			metrics.io( config.devices.cost( device, cycles ) );
+		}
+	}
+	
+	for( int device = 0; device < deviceCount; device++ ) {
+		
+		for( int cycles = 0; cycles < COUNTED_CYCLES; cycles++ ) {
+			
+			long count = counts[ device * COUNTED_CYCLES + cycles ];
+			long time = config.devices.cost( device, cycles );
+			
+			if( count == 0 ) {
+				
+				continue;
+			}
+			
+			if( device == DeviceTable::RUN ) {
+				
+				metrics.slice( time, count );
+				core.busyTime += count * time;
+				core.slices += count;
+			}
+			else {
+				
+				metrics.io( time, count );
+				deviceTime[ device ] += count * time;
+			}
+		}
+	}
+	
+	// the cpu totals of the big operations that went straight into the
+	// histograms
+	for( int i = 0; i < table.size(); i++ ) {
+		
+		int cycles = table.cycles( i );
+		
+		if( cycles < 0 || cycles >= COUNTED_CYCLES ) {
+			
+			if( table.device( i ) == DeviceTable::RUN ) {
+				
+				core.busyTime += config.devices.cost( DeviceTable::RUN, cycles );
+				core.slices++;
+			}
+			else {
+				
+				deviceTime[ table.device( i ) ] += config.devices.cost( table.device( i ), cycles );
+			}
+		}
+	}
+	
+	// the jobs arrive in the order they run, each one gets the core when
+	// the one before it exits or when it arrives if the core was idle
+	while( !events.empty() ) {
+		
+		Event event = events.next();
+		Job &job = jobs[ event.handle ];
+		
+		job.arrivalTime = event.time;
+		job.startTime = max( clock, event.time );
+		job.remainingTime = 0;
+		job.currentOperation = job.numberOfOperations;
+		clock = job.startTime + job.timeToProcessJob;
+		
+		jobsDone++;
+		turnaroundTime += clock - job.arrivalTime;
+		waitingTime += job.startTime - job.arrivalTime;
+		liveJobs--;
+		
+		metrics.exit( job.PID, job.arrivalTime, job.startTime, clock, job.timeToProcessJob );
+	}
+}
+
+bool Scheduler::runsAlone( int c ) {
+	
+	// the job has to go back to the same core, without affinity it could
+	// be put on any idle core.. jobs still streaming in could arrive at
+	// the end of any quantum & a paced run has to wait for every quantum
+	if( ( cores.size() > 1 && !config.affinity ) || stream != NULL || pacer.enabled() ) {
+		
+		return false;
+	}
+	
+	// anything waiting for a core or for memory, or anything else that
+	// happens right now, would get its turn at the end of the quantum
+	if( readyJobs > 0 || memoryReleased || moreEventsNow() ) {
+		
+		return false;
+	}
+	
+	// dispatch would still have something to tidy up or start
+	for( int i = 0; i < (int) cores.size(); i++ ) {
+		
+		if( i != c && cores[ i ].currentJob == -1 && cores[ i ].lastJob != -1 ) {
+			
+			return false;
+		}
+	}
+	
+	for( int device = 0; device < (int) waitQueues.size(); device++ ) {
+		
+		if( !waitQueues[ device ].empty() && busyChannels[ device ] < config.devices.channelCount( device ) ) {
+			
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+void Scheduler::fastForward( int c ) {
+	
+	Core &core = cores[ c ];
+	Job &job = jobs[ core.currentJob ];
+	int cycles = config.quantom;
+	long time = calculateTimeToProcessOperation( job, cycles );
+	
+	if( cycles < 1 ) {
+		
+		return;
+	}
+	
+	// every quantum but the one that finishes the operation, & only the
+	// ones that end before the next event.. the last one is left to
+	// the event queue so the slice ending is handled like any other
+	long quanta = ( job.remainingCycles - 1 ) / cycles;
+	
+	if( !events.empty() && time > 0 ) {
+		
+		quanta = min( quanta, ( events.nextTime() - clock - 1 ) / time );
+	}
+	
+	if( quanta <= 0 ) {
+		
+		return;
+	}
+	
+	// each quantum is logged & traced just like the job being swapped back
+	// in & run, only the lines cost anything when nothing is logged
+	if( log.level >= LOG_ALL || trace.enabled() ) {
+		
+		long start = clock;
+		
+		for( long i = 0; i < quanta; i++ ) {
+			
+			stamp( LOG_ALL ) << "SYSTEM - Swapping Processes" << endl;
+			stamp( LOG_ALL ) << "PID " << job.PID << "  - Processing " 
+							 << config.devices.name( jobs.device( job ) ) 
+							 << " ( " << time << " mSec )";
+			
+			if( cores.size() > 1 ) {
+				
+				log << " on core " << c;
+			}
+			
+			log << endl;
+			
+			if( trace.enabled() ) {
+				
+				trace.slice( c, job.PID, clock, clock + time );
+			}
+			
+			clock += time;
+		}
+		
+		clock = start;
+	}
+	
+	runCPU( job, quanta * cycles );
+	metrics.slice( time, quanta );
+	
+	core.busyTime += quanta * time;
+	core.slices += quanta;
+	clock += quanta * time;
+}
+
+void Scheduler::queueOnCore( int handle ) {
+	
+	int core = jobs[ handle ].core;
+	
+	// with affinity a job that already ran goes back to the same core, 
+	// its cache would still be warm there.. anything else goes to the core
+	// with the least work waiting
+	if( !config.affinity || core == -1 ) {
+		
+		core = nextCore;
+		
+		for( int n = 1; n < (int) cores.size(); n++ ) {
+			
+			int i = ( nextCore + n ) % cores.size();
+			
+			if( cores[ i ].readyQueue.size() + ( cores[ i ].currentJob != -1 ) < 
+				cores[ core ].readyQueue.size() + ( cores[ core ].currentJob != -1 ) ) {
+				
+				core = i;
+			}
+		}
+		
+		// ties go round the cores instead of always landing on core 0
+		nextCore = ( core + 1 ) % cores.size();
+	}
+	
+	cores[ core ].readyQueue.push_back( handle );
+	readyJobs++;
+}
+
+// SRTF jobs all wait in the one heap, the job might have less left than
+// one of the jobs running so it could take its core
+void Scheduler::queueByRemaining( int handle ) {
+	
+	readyHeap.push( handle, jobs[ handle ].remainingTime );
+	readyJobs++;
+	
+	preemptFor( handle );
+}
+
+int Scheduler::takeShortest() {
+	
+	if( readyHeap.empty() ) {
+		
+		return -1;
+	}
+	
+	readyJobs--;
+	
+	return readyHeap.pop();
+}
+
+void Scheduler::queueByLevel( int handle ) {
+	
+	int level = levelOf( jobs[ handle ] );
+	
+	levelQueues[ level ].push_back( handle );
+	levelBits |= 1UL << level;
+	readyJobs++;
+}
+
+int Scheduler::takeHighest() {
+	
+	// the boost is only seen by the jobs when one is picked, until then
+	// it makes no difference what level they are waiting on
+	if( config.mlfqBoost > 0 && clock >= nextBoost ) {
+		
+		boostLevels();
+	}
+	
+	if( levelBits == 0 ) {
+		
+		return -1;
+	}
+	
+	// one instruction finds the highest level with a job, however many
+	// jobs are waiting
+	int level = __builtin_ctzl( levelBits );
+	int handle = levelQueues[ level ].front();
+	
+	levelQueues[ level ].pop_front();
+	readyJobs--;
+	
+	if( levelQueues[ level ].empty() ) {
+		
+		levelBits &= ~( 1UL << level );
+	}
+	
+	return handle;
+}
+
+int Scheduler::levelOf( Job &job ) {
+	
+	// jobs on a core or a device are not on any queue, so a boost leaves
+	// their level as it was & it is put back to 0 the next time it is read
+	if( job.levelBoost != boosts ) {
+		
+		job.level = 0;
+		job.levelBoost = boosts;
+	}
+	
+	return job.level;
+}
+
+int Scheduler::levelQuantum( Job &job ) {
+	
+	return levelQuanta[ levelOf( job ) ];
+}
+
+void Scheduler::demote( Event &event ) {
+	
+	Job &job = jobs[ event.handle ];
+	
+	// a slice that ended before the quantum ran out finished the operation,
+	// only a job still working on it used its whole quantum
+	if( job.remainingCycles > event.cycles && levelOf( job ) < (int) levelQuanta.size() - 1 ) {
+		
+		job.level++;
+		demotions++;
+		
+		stamp( LOG_ALL ) << "SYSTEM - Moving PID " << job.PID << " down to level " << job.level << endl;
+	}
+}
+
+void Scheduler::promote( int handle ) {
+	
+	Job &job = jobs[ handle ];
+	
+	// a job that waited on io is likely to be interactive, so it moves up
+	if( levelOf( job ) > 0 ) {
+		
+		job.level--;
+		promotions++;
+		
+		stamp( LOG_ALL ) << "SYSTEM - Moving PID " << job.PID << " up to level " << job.level << endl;
+	}
+}
+
+void Scheduler::boostLevels() {
+	
+	boosts++;
+	nextBoost = ( clock / config.mlfqBoost + 1 ) * config.mlfqBoost;
+	
+	// every level is put on the end of the top one in order, so the jobs
+	// that were higher still go first
+	for( int level = 1; level < (int) levelQueues.size(); level++ ) {
+		
+		levelQueues[ 0 ].insert( levelQueues[ 0 ].end(), levelQueues[ level ].begin(), levelQueues[ level ].end() );
+		levelQueues[ level ].clear();
+	}
+	
+	levelBits = ( levelQueues[ 0 ].empty() ? 0 : 1 );
+	
+	stamp( LOG_ALL ) << "SYSTEM - Boosting every job to level 0" << endl;
+}
+
+void Scheduler::preemptFor( int handle ) {
+	
+	int victim = -1;
+	long most = jobs[ handle ].remainingTime;
+	
+	for( int c = 0; c < (int) cores.size(); c++ ) {
+		
+		Core &core = cores[ c ];
+		
+		// a free core is going to take a job anyway, nothing has to give
+		// up its core
+		if( core.currentJob == -1 ) {
+			
+			return;
+		}
+		
+		// the work a running job has left goes down as its slice runs, a 
+		// slice that ends right now is not worth stopping
+		long left = jobs[ core.currentJob ].remainingTime - ( clock - core.sliceStart );
+		
+		if( core.cpuBusy && core.sliceEnd > clock && left > most ) {
+			
+			victim = c;
+			most = left;
+		}
+	}
+	
+	if( victim != -1 ) {
+		
+		preempt( victim );
+	}
+}
+
+void Scheduler::preempt( int c ) {
+	
+	Core &core = cores[ c ];
+	Job &job = jobs[ core.currentJob ];
+	long cycleTime = calculateTimeToProcessOperation( job, 1 );
+	int cycles = core.sliceCycles;
+	
+	// only the cycles that were finished count, whatever was done on the
+	// cycle that got cut off is lost
+	if( cycleTime > 0 ) {
+		
+		cycles = min( (long) cycles, ( clock - core.sliceStart ) / cycleTime );
+	}
+	
+	stamp( LOG_ALL ) << "SYSTEM - Preempting PID " << job.PID << endl;
+	
+	runCPU( job, cycles );
+	metrics.slice( clock - core.sliceStart );
+	
+	if( trace.enabled() ) {
+		
+		trace.slice( c, job.PID, core.sliceStart, clock );
+	}
+	
+	// the core was counted busy for the whole slice when it started
+	core.busyTime -= core.sliceEnd - clock;
+	
+	// the event ending the slice is still on the event queue, it is 
+	// ignored when it comes up
+	core.sliceEvent = -1;
+	core.cpuBusy = false;
+	core.lastJob = core.currentJob;
+	core.currentJob = -1;
+	
+	readyHeap.push( core.lastJob, job.remainingTime );
+	readyJobs++;
+}
+
+bool Scheduler::staleSlice( Event &event ) {
+	
+	Job &job = jobs[ event.handle ];
+	
+	return ( job.core == -1 || cores[ job.core ].sliceEvent != event.sequence );
+}
+
+int Scheduler::takeFromCore( int c, bool stealing ) {
+	
+	Core &core = cores[ c ];
+	
+	// if nothing is waiting for the core it can steal a job
+	if( core.readyQueue.empty() && !( stealing && steal( c ) ) ) {
+		
+		return -1;
+	}
+	
+	int handle = core.readyQueue.front();
+	
+	core.readyQueue.pop_front();
+	readyJobs--;
+	
+	return handle;
+}
+
+// an idle core with nothing waiting on it takes the job at the back of
+// the longest ready queue, that job would have waited the longest
+bool Scheduler::steal( int thief ) {
+	
+	int victim = -1;
+	size_t longest = 0;
+	
+	// the thief's own queue is empty, so nothing waiting means nothing to take
+	if( readyJobs == 0 ) {
+		
+		return false;
+	}
+	
+	for( int i = 0; i < (int) cores.size(); i++ ) {
+		
+		if( i != thief && cores[ i ].readyQueue.size() > longest ) {
+			
+			victim = i;
+			longest = cores[ i ].readyQueue.size();
+		}
+	}
+	
+	if( victim == -1 ) {
+		
+		return false;
+	}
+	
+	cores[ thief ].readyQueue.push_back( cores[ victim ].readyQueue.back() );
+	cores[ victim ].readyQueue.pop_back();
+	steals++;
+	
+	return true;
+}
+
+void Scheduler::continueJob( int c ) {
+	
+	Core &core = cores[ c ];
+	Job &job = jobs[ core.currentJob ];
+	int wait = waitingOn( job );
+	
+	// the job is finished, the core can go to the next job
+	if( wait == WAIT_EXIT ) {
+		
+		exitJob( core.currentJob );
+		core.currentJob = -1;
+	}
+	// the job keeps the core while it does its io, nothing else gets
+	// to run on it until it is done
+	else if( wait == WAIT_IO ) {
+		
+		stamp( LOG_ALL ) << "SYSTEM - Managing I/O" << endl;
+		waitQueues[ jobs.device( job ) ].push( core.currentJob );
+	}
+	
+	// otherwise the next operation is a cpu one & dispatch starts it
+}
+
+template<class Policy>
+void Scheduler::dispatch() {
+	
+	PROFILE_SCOPE( PROFILE_DISPATCH );
+	
+	// jobs that get memory now that a job is gone go on the ready queues
+	// before any core picks a job
+	swapIn<Policy>();
+	
+	// every core first takes the jobs that were given to it, only then do
+	// the cores still idle steal what is left.. otherwise the lowest 
+	// numbered cores would steal every job before its own core got to it
+	for( int c = 0; c < (int) cores.size(); c++ ) {
+		
+		fillCore<Policy>( c, false );
+	}
+	
+	for( int c = 0; c < (int) cores.size() && readyJobs > 0; c++ ) {
+		
+		fillCore<Policy>( c, true );
+	}
+	
+	for( int c = 0; c < (int) cores.size(); c++ ) {
+		
+		Core &core = cores[ c ];
+		
+		if( core.currentJob == -1 ) {
+			
+			// nothing to run, the core sits idle
+			core.lastJob = -1;
+		}
+		// a FIFO or SJF job holds on to its core while it does io
+		else if( !core.cpuBusy && waitingOn( jobs[ core.currentJob ] ) == WAIT_CPU ) {
+			
+			startSlice<Policy>( c );
+		}
+	}
+	
+	// every free channel of a device goes to the job at the front of that
+	// devices wait queue, devices work at the same time as each other & 
+	// the cpu
+	for( int device = 0; device < (int) waitQueues.size(); device++ ) {
+		
+		while( busyChannels[ device ] < config.devices.channelCount( device ) && 
+			   !waitQueues[ device ].empty() ) {
+			
+			startIO( device );
+		}
+	}
+}
+
+template<class Policy>
+void Scheduler::fillCore( int c, bool stealing ) {
+	
+	Core &core = cores[ c ];
+	int handle;
+	
+	// the core is free so the next job waiting for it gets it
+	while( core.currentJob == -1 && ( handle = Policy::pickNext( *this, c, stealing ) ) != -1 ) {
+		
+		if( Policy::preemptive && core.lastJob != -1 ) {
+			
+			stamp( LOG_ALL ) << "SYSTEM - Swapping Processes" << endl;
+		}
+		
+		core.currentJob = handle;
+		
+		Job &job = jobs[ core.currentJob ];
+		
+		if( job.core != -1 && job.core != c ) {
+			
+			migrations++;
+		}
+		
+		job.core = c;
+		
+		// a FIFO or SJF job could start with io or have nothing to do
+		if( !Policy::preemptive ) {
+			
+			continueJob( c );
+		}
+	}
+}
+
+template<class Policy>
+void Scheduler::startSlice( int c ) {
+	
+	Core &core = cores[ c ];
+	Job &job = jobs[ core.currentJob ];
+	int cycles = Policy::sliceCycles( *this, job );
+	
+	// a slice that did no cycles would never finish the operation & the
+	// clock would never move, an operation with cycles left gets at least one
+	cycles = max( cycles, min( 1, job.remainingCycles ) );
+	
+	long time = calculateTimeToProcessOperation( job, cycles );
+	
+	// print to console, file or both
+	stamp( LOG_ALL ) << "PID " << job.PID << "  - Processing " 
+					 << config.devices.name( jobs.device( job ) ) 
+					 << " ( " << time << " mSec )";
+	
+	if( cores.size() > 1 ) {
+		
+		log << " on core " << c;
+	}
+	
+	log << endl;
+	
+	if( job.startTime == -1 ) {
+		
+		job.startTime = clock;
+	}
+	
+	core.sliceEvent = events.schedule( clock + time, SLICE_END, core.currentJob, cycles );
+	core.sliceStart = clock;
+	core.sliceEnd = clock + time;
+	core.sliceCycles = cycles;
+	core.cpuBusy = true;
+	core.busyTime += time;
+	core.slices++;
+}
+
+void Scheduler::startIO( int device ) {
+	
+	int handle = waitQueues[ device ].front();
+	waitQueues[ device ].pop();
+	
+	Job &job = jobs[ handle ];
+	long time = calculateTimeToProcessOperation( job, job.remainingCycles );
+	
+	// print to console, file or both
+	stamp( LOG_ALL ) << "PID " << job.PID;
+	ioPrint( job ); 
+	log << " started" << endl;
+	
+	if( job.startTime == -1 ) {
+		
+		job.startTime = clock;
+	}
+	
+	metrics.io( time );
+	
+	if( trace.enabled() ) {
+		
+		trace.io( device, job.PID, clock, clock + time );
+	}
+	
+	events.schedule( clock + time, IO_COMPLETE, handle, job.remainingCycles );
+	busyChannels[ device ]++;
+	deviceTime[ device ] += time;
+}
+
+// FIFO or SJF io management
+void Scheduler::ioManagement( Event &event ) {
+	
+	PROFILE_SCOPE( PROFILE_IO_MANAGEMENT );
+	
+	Job &job = jobs[ event.handle ];
+	
+	// print to console, file or both
+	stamp( LOG_ALL ) << "PID " << job.PID;
+	ioPrint( job ); 
+	log << " completed ( " 
+	    << calculateTimeToProcessOperation( job, event.cycles ) 
+	    << " mSec )" << endl;     
+	
+	// the channel is free again & the job goes on with its next operation
+	busyChannels[ jobs.device( job ) ]--;
+	
+	runCPU( job, event.cycles );
+	resume( job );
+	
+	continueJob( job.core );
+}
+
+template<class Policy>
+void Scheduler::ioPreemptive( Event &event ) {
+	
+	PROFILE_SCOPE( PROFILE_IO_PREEMPTIVE );
+	
+	Job &job = jobs[ event.handle ];
+	
+	// print to console, file or both
+	stamp( LOG_ALL ) << "PID " << job.PID;
+	ioPrint( job ); 
+	log << " completed ( " 
+	    << calculateTimeToProcessOperation( job, event.cycles ) 
+	    << " mSec )" << endl;
+	
+	// the channel is free again, if the next operation is IO the job goes
+	// to the back of that devices wait queue otherwise the ready queue
+	busyChannels[ jobs.device( job ) ]--;
+	
+	runCPU( job, event.cycles );
+	resume( job );
+	
+	requeue<Policy>( event.handle );
+}
+
+// FIFO or SJF ready queue algorithm, both use the same algorithm
+// the SJF is already sorted so we can just process all the jobs
+void Scheduler::nonPreemptive( Event &event ) {
+	
+	PROFILE_SCOPE( PROFILE_NON_PREEMPTIVE );
+	
+	Job &job = jobs[ event.handle ];
+	
+	// the whole operation was processed in one slice
+	runCPU( job, event.cycles );
+	metrics.slice( clock - cores[ job.core ].sliceStart );
+	
+	if( trace.enabled() ) {
+		
+		trace.slice( job.core, job.PID, cores[ job.core ].sliceStart, clock );
+	}
+	
+	resume( job );
+	
+	cores[ job.core ].cpuBusy = false;
+	
+	continueJob( job.core );
+}
+
+// round robin scheduling algorithm
+template<class Policy>
+void Scheduler::RoundRobin( Event &event ) {
+	
+	PROFILE_SCOPE( PROFILE_ROUND_ROBIN );
+	
+	// the slice was cut short & the job already gave up its core
+	if( staleSlice( event ) ) {
+		
+		return;
+	}
+	
+	Job &job = jobs[ event.handle ];
+	
+	// take off however many cycles the slice got through, this could be
+	// as much as the time quantom or less depending on how many cycles 
+	// were left on the jobs operations
+	runCPU( job, event.cycles );
+	metrics.slice( clock - cores[ job.core ].sliceStart );
+	
+	if( trace.enabled() ) {
+		
+		trace.slice( job.core, job.PID, cores[ job.core ].sliceStart, clock );
+	}
+	
+	// a long cpu burst with nothing else to run would otherwise go round
+	// the event queue once a quantum, this moves the clock up past every
+	// quantum it would have had to itself
+	if( Policy::fastForward && !job.operationFinished() && runsAlone( job.core ) ) {
+		
+		fastForward( job.core );
+	}
+	
+	// if jobs operation is finished then move to next operation,
+	// other wise the jobs operation still needs processing
+	resume( job );
+	
+	// either way the job gives up the core & goes to the back of a 
+	// ready queue, the wait queue or exits
+	Core &core = cores[ job.core ];
+	
+	core.cpuBusy = false;
+	core.lastJob = core.currentJob;
+	core.currentJob = -1;
+	
+	requeue<Policy>( event.handle );
+}
@@ -0,0 +1,398 @@
+#include "OS.cpp"
+#include <atomic>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// a setting of the config file & every value the sweep should try for it
+struct SweepSetting {
+	
+	string name;	// same as in the config file, like Quantum(cycles)
+	vector<string> values;
+};
+
+// what came out of running one point of the sweep
+struct SweepResult {
+	
+	long finishTime;	// simulated time ( msec ) the last job exited
+	int jobsDone;
+	long turnaroundTime;	// added up over every job
+	long waitingTime;	// added up over every job
+	double cpuUtilization;	// percent of the time the cores were busy
+};
+
+// a sweep runs the same workload with every combination of a few config
+// settings & prints one table to compare them.. the metadata is read once,
+// every point only copies the jobs ( not their operations ) & runs as its
+// own simulation, the points are spread over a pool of threads
+class Sweep {
+	
+	public:
+		
+		// constructor, reads the sweep file & the config file, runs every
+		// point & prints the table
+		Sweep( string, string );
+		
+		// reads the settings to sweep over, returns false if it is bad
+		bool readSweep( string );
+		
+		// reads the config & the metadata every point starts from
+		bool loadWorkload( string );
+		
+		// makes the config of every combination of the settings
+		void buildPoints();
+		
+		// sets a setting of the config to the value
+		void apply( Configure &, string &, string & );
+		
+		// true if every value is a quantum of at least 1 cycle
+		bool validQuanta( vector<string> & );
+		
+		// runs every point on the threads
+		void run();
+		
+		// runs a single point as its own simulation
+		void runPoint( int );
+		
+		// prints a row for every point
+		void printTable();
+		
+		OS base; // the config & jobs every point starts from
+		
+		vector<SweepSetting> settings; // the settings being swept
+		vector< vector<int> > choices; // index of the value of every setting, for every point
+		vector<Configure> points; // config of every point
+		vector<SweepResult> results; // result of every point
+		
+		int threads; // number of points run at the same time
+};
+
+Sweep::Sweep( string sweepFile, string configFile ) {
+	
+	threads = thread::hardware_concurrency();
+	
+	if( !readSweep( sweepFile ) || !loadWorkload( configFile ) ) {
+		
+		return;
+	}
+	
+	buildPoints();
+	run();
+	printTable();
+}
+
+// the sweep file has a line for each setting to sweep over with the name
+// it has in the config file & the values to try separated by commas, like
+// Quantum(cycles): 2, 4, 8
+// Processor Scheduling: FIFO, SJF, Round Robin
+bool Sweep::readSweep( string filename ) {
+	
+	ifstream fin( filename.c_str() );
+	string line;
+	
+	if( !fin ) {
+		
+		cerr << "Error: " << filename << ": could not open sweep file" << endl;
+		return false;
+	}
+	
+	while( getline( fin, line ) ) {
+		
+		size_t colon = line.find( ':' );
+		
+		if( colon == string::npos ) {
+			
+			continue;
+		}
+		
+		SweepSetting setting;
+		string value;
+		stringstream values( line.substr( colon + 1 ) );
+		
+		setting.name = line.substr( 0, colon );
+		
+		while( getline( values, value, ',' ) ) {
+			
+			// the spaces around a value are not part of it
+			size_t first = value.find_first_not_of( " \t\r" );
+			size_t last = value.find_last_not_of( " \t\r" );
+			
+			if( first != string::npos ) {
+				
+				setting.values.push_back( value.substr( first, last - first + 1 ) );
+			}
+		}
+		
+		if( setting.name == "Sweep threads" ) {
+			
+			threads = max( 1, atoi( setting.values.empty() ? "1" : setting.values[ 0 ].c_str() ) );
+		}
+		else if( setting.name != "Quantum(cycles)" && setting.name != "Processor Scheduling" &&
+				 setting.name != "Processors" && setting.name.compare( 0, 7, "Memory " ) != 0 &&
+				 setting.name != "MLFQ levels" && setting.name != "MLFQ boost (msec)" &&
+				 setting.name.find( "time (msec)" ) == string::npos ) {
+			
+			cerr << "Error: " << filename << ": \"" << setting.name << "\" can not be swept" << endl;
+			return false;
+		}
+		// a point with a quantum below 1 cycle would never finish
+		else if( setting.name == "Quantum(cycles)" && !validQuanta( setting.values ) ) {
+			
+			cerr << "Error: " << filename << ": every quantum has to be at least 1 cycle" << endl;
+			return false;
+		}
+		else if( !setting.values.empty() ) {
+			
+			settings.push_back( setting );
+		}
+	}
+	
+	return true;
+}
+
+bool Sweep::validQuanta( vector<string> &values ) {
+	
+	for( int i = 0; i < (int) values.size(); i++ ) {
+		
+		if( atoi( values[ i ].c_str() ) < 1 ) {
+			
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+bool Sweep::loadWorkload( string filename ) {
+	
+	base.configureSystem( filename );
+	
+	// the jobs are only read here, every point gets a copy of them that
+	// still points at the operations in this table
+	return base.readMetaData();
+}
+
+void Sweep::buildPoints() {
+	
+	vector<int> choice( settings.size(), 0 );
+	
+	// count through every combination like the digits of a number, the
+	// last setting changes the fastest
+	while( true ) {
+		
+		Configure config = base.systemConfig;
+		
+		// the points only fill in the table, they would all write the same file
+		config.metricsFile = "";
+		config.checkpointFile = "";
+		config.traceFile = "";
+		config.pace = 0;
+		
+		for( int i = 0; i < (int) settings.size(); i++ ) {
+			
+			apply( config, settings[ i ].name, settings[ i ].values[ choice[ i ] ] );
+		}
+		
+		points.push_back( config );
+		choices.push_back( choice );
+		
+		int i = settings.size() - 1;
+		
+		while( i >= 0 && ++choice[ i ] == (int) settings[ i ].values.size() ) {
+			
+			choice[ i ] = 0;
+			i--;
+		}
+		
+		if( i < 0 ) {
+			
+			break;
+		}
+	}
+}
+
+void Sweep::apply( Configure &config, string &name, string &value ) {
+	
+	int number = atoi( value.c_str() );
+	
+	if( name == "Quantum(cycles)" ) {
+		
+		config.quantom = max( 1, number );
+	}
+	else if( name == "Processor Scheduling" ) {
+		
+		config.processorScheduling = value;
+	}
+	else if( name == "Processors" ) {
+		
+		config.processors = number;
+	}
+	else if( name == "MLFQ levels" ) {
+		
+		config.mlfqLevels = number;
+	}
+	else if( name == "MLFQ boost (msec)" ) {
+		
+		config.mlfqBoost = number;
+	}
+	else if( name == "Memory type" ) {
+		
+		config.memoryType = value;
+	}
+	else if( name == "Memory size (KB)" ) {
+		
+		config.memorySize = atol( value.c_str() );
+	}
+	else if( name == "Memory partitions" ) {
+		
+		config.memoryPartitions = max( 1, number );
+	}
+	else if( name == "Memory frames" ) {
+		
+		config.memoryFrames = atol( value.c_str() );
+	}
+	else if( name == "Processor cycle time (msec)" ) {
+		
+		config.processorCycleTime = number;
+		config.devices.setCycleTime( DeviceTable::RUN, number );
+	}
+	else if( name == "Monitor display time (msec)" ) {
+		
+		config.monitorDisplayTime = number;
+		config.devices.setCycleTime( DeviceTable::MONITOR, number );
+	}
+	else if( name == "Hard drive cycle time (msec)" ) {
+		
+		config.hardDriveCycleTime = number;
+		config.devices.setCycleTime( DeviceTable::HARD_DRIVE, number );
+	}
+	else if( name == "Printer cycle time (msec)" ) {
+		
+		config.printerCycleTime = number;
+		config.devices.setCycleTime( DeviceTable::PRINTER, number );
+	}
+	else if( name == "Keyboard cycle time (msec)" ) {
+		
+		config.keyboardCycleTime = number;
+		config.devices.setCycleTime( DeviceTable::KEYBOARD, number );
+	}
+	// a device added in the config, like Device (scanner) cycle time (msec)
+	else if( name.compare( 0, 8, "Device (" ) == 0 ) {
+		
+		int device = config.devices.lookup( name.substr( 8, name.find( ')' ) - 8 ) );
+		
+		if( device != -1 ) {
+			
+			config.devices.setCycleTime( device, number );
+		}
+	}
+}
+
+void Sweep::run() {
+	
+	atomic<int> next( 0 );
+	vector<thread> workers;
+	
+	results.resize( points.size() );
+	
+	// every thread keeps taking the next point until there are none left,
+	// points with slow settings do not hold up the other threads
+	for( int i = 0; i < min( threads, (int) points.size() ); i++ ) {
+		
+		workers.emplace_back( [ & ]() {
+			
+			int point;
+			
+			while( ( point = next++ ) < (int) points.size() ) {
+				
+				runPoint( point );
+			}
+		} );
+	}
+	
+	for( int i = 0; i < (int) workers.size(); i++ ) {
+		
+		workers[ i ].join();
+	}
+}
+
+void Sweep::runPoint( int point ) {
+	
+	OS os;
+	
+	os.systemConfig = points[ point ];
+	os.scheduler.config = points[ point ];
+	
+	// the output of the simulation is not wanted, only the numbers
+	os.scheduler.log.level = LOG_NONE;
+	
+	// the cycle times can be different for every point, so the time of
+	// every job is worked out again for SJF
+	os.scheduler.jobs.share( base.scheduler.jobs );
+	os.scheduler.jobs.recost( os.systemConfig.devices );
+	
+	os.startJobs();
+	os.simulate();
+	
+	Scheduler &scheduler = os.scheduler;
+	SweepResult &result = results[ point ];
+	long busyTime = 0;
+	
+	for( int i = 0; i < (int) scheduler.cores.size(); i++ ) {
+		
+		busyTime += scheduler.cores[ i ].busyTime;
+	}
+	
+	result.finishTime = scheduler.clock;
+	result.jobsDone = scheduler.jobsDone;
+	result.turnaroundTime = scheduler.turnaroundTime;
+	result.waitingTime = scheduler.waitingTime;
+	result.cpuUtilization = ( scheduler.clock == 0 ? 0 :
+							  100.0 * busyTime / ( (double) scheduler.clock * scheduler.cores.size() ) );
+}
+
+void Sweep::printTable() {
+	
+	vector<int> widths;
+	
+	// every column is as wide as its name or its longest value
+	for( int i = 0; i < (int) settings.size(); i++ ) {
+		
+		int width = settings[ i ].name.size();
+		
+		for( int j = 0; j < (int) settings[ i ].values.size(); j++ ) {
+			
+			width = max( width, (int) settings[ i ].values[ j ].size() );
+		}
+		
+		widths.push_back( width + 2 );
+		cout << left << setw( widths[ i ] ) << settings[ i ].name;
+	}
+	
+	cout << right << setw( 14 ) << "Finish (mSec)" << setw( 18 ) << "Throughput (j/s)"
+		 << setw( 20 ) << "Turnaround (mSec)" << setw( 18 ) << "Waiting (mSec)"
+		 << setw( 10 ) << "CPU %" << endl;
+	
+	cout << fixed << setprecision( 1 );
+	
+	// turnaround & waiting are averages over the jobs of the point
+	for( int p = 0; p < (int) points.size(); p++ ) {
+		
+		SweepResult &result = results[ p ];
+		int jobs = max( 1, result.jobsDone );
+		
+		for( int i = 0; i < (int) settings.size(); i++ ) {
+			
+			cout << left << setw( widths[ i ] ) << settings[ i ].values[ choices[ p ][ i ] ];
+		}
+		
+		cout << right << setw( 14 ) << result.finishTime
+			 << setw( 18 ) << ( result.finishTime == 0 ? 0 : 1000.0 * result.jobsDone / result.finishTime )
+			 << setw( 20 ) << (double) result.turnaroundTime / jobs
+			 << setw( 18 ) << (double) result.waitingTime / jobs
+			 << setw( 10 ) << result.cpuUtilization << endl;
+	}
+}
@@ -0,0 +1,298 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using namespace std;
+
+// the trace is a timeline of the simulation in the Chrome trace format,
+// it opens in chrome://tracing or ui.perfetto.dev.. there is a track for
+// every core, every channel of every device & every job, each slice &
+// io operation shows up on its core or device & on its job, & every job
+// has a span from arriving to exiting with its slices & io inside it..
+// the events are written as they happen through a buffer of a fixed size
+// so a trace of a billion events needs no more memory than a trace of ten
+class Trace {
+	
+	public:
+		
+		// constructor & destructor
+		Trace();
+		~Trace();
+		
+		// starts writing the trace to the file & names the tracks of the
+		// cores & devices, the file is started over unless it is given the
+		// number of bytes of it to keep.. returns false if it could not be opened
+		bool open( string, int, DeviceTable &, long = -1 );
+		
+		// a slice ran a job on the core between the times ( msec )
+		void slice( int, int, long, long );
+		
+		// a device did an io operation of a job between the times ( msec )
+		void io( int, int, long, long );
+		
+		// a job was in the system between the times ( msec )
+		void job( int, long, long );
+		
+		// writes what is left & ends the trace, returns false if any of it
+		// could not be written
+		bool close();
+		
+		// writes out everything traced so far
+		bool flush();
+		
+		bool enabled() {
+			
+			return ( fout != NULL );
+		}
+		
+		// bytes traced since the file was started, counting any that were kept
+		long traced() {
+			
+			return written + used;
+		}
+		
+		vector< vector<long> > channelEnds; // when the last io on every channel of every device ends ( msec )
+	
+	private:
+		
+		// the track ids of the kinds of track, the cores & devices are threads
+		// of one process each & every job is a thread of the jobs process
+		static const int CPU_TRACKS = 1;
+		static const int DEVICE_TRACKS = 2;
+		static const int JOB_TRACKS = 3;
+		
+		static const int BUFFER_SIZE = 1 << 16;
+		
+		// a span on a track from the start to the end ( msec )
+		void span( const char *, int, long, long, long );
+		
+		// names a track or a process of tracks
+		void name( const char *, int, long, const char * );
+		
+		// the name with anything that would end or break a JSON string
+		// escaped, the names of devices come straight from the config
+		static string escape( const string & );
+		
+		// room for one more event with a name of the length in the buffer
+		void reserve( size_t );
+		
+		FILE *fout;
+		char buffer[ BUFFER_SIZE ];
+		int used; // bytes in the buffer
+		long written; // bytes written to the file
+		
+		vector<string> deviceNames;
+		vector<int> firstChannel; // track of the first channel of every device
+};
+
+Trace::Trace() {
+	
+	fout = NULL;
+	used = 0;
+	written = 0;
+}
+
+Trace::~Trace() {
+	
+	close();
+}
+
+bool Trace::open( string filename, int cores, DeviceTable &devices, long keep ) {
+	
+	fout = fopen( filename.c_str(), ( keep < 0 ? "w" : "r+" ) );
+	
+	if( fout == NULL ) {
+		
+		return false;
+	}
+	
+	// whatever was traced after the bytes that are kept is traced again
+	if( keep >= 0 && ( ftruncate( fileno( fout ), keep ) == -1 || fseek( fout, keep, SEEK_SET ) != 0 ) ) {
+		
+		fclose( fout );
+		fout = NULL;
+		
+		return false;
+	}
+	
+	deviceNames.clear();
+	firstChannel.clear();
+	channelEnds.assign( devices.size(), vector<long>() );
+	
+	int track = 0;
+	
+	// the cpu is a device too but its slices are on the cores, so it has no
+	// channels of its own
+	for( int device = 0; device < devices.size(); device++ ) {
+		
+		deviceNames.push_back( escape( devices.name( device ) ) );
+		firstChannel.push_back( track );
+		channelEnds[ device ].assign( ( device == DeviceTable::RUN ? 0 : devices.channelCount( device ) ), 0 );
+		track += channelEnds[ device ].size();
+	}
+	
+	if( keep >= 0 ) {
+		
+		written = keep;
+		return true;
+	}
+	
+	// the opening [ is the whole header, the closing ] is optional so a
+	// trace of a run that was stopped can still be opened
+	buffer[ used++ ] = '[';
+	
+	name( "process_name", CPU_TRACKS, 0, "CPU" );
+	name( "process_name", DEVICE_TRACKS, 0, "Devices" );
+	name( "process_name", JOB_TRACKS, 0, "Jobs" );
+	
+	for( int core = 0; core < cores; core++ ) {
+		
+		name( "thread_name", CPU_TRACKS, core, ( "core " + to_string( core ) ).c_str() );
+	}
+	
+	for( int device = 0; device < devices.size(); device++ ) {
+		
+		// the first channel has the name of the device, any others are numbered
+		for( int channel = 0; channel < (int) channelEnds[ device ].size(); channel++ ) {
+			
+			string channelName = deviceNames[ device ] + ( channel == 0 ? "" : " " + to_string( channel + 1 ) );
+			
+			name( "thread_name", DEVICE_TRACKS, firstChannel[ device ] + channel, channelName.c_str() );
+		}
+	}
+	
+	return true;
+}
+
+string Trace::escape( const string &text ) {
+	
+	string escaped;
+	char code[ 8 ];
+	
+	for( int i = 0; i < (int) text.size(); i++ ) {
+		
+		unsigned char c = text[ i ];
+		
+		if( c == '"' || c == '\\' ) {
+			
+			escaped += '\\';
+			escaped += c;
+		}
+		// control characters can only be written as their code
+		else if( c < 0x20 ) {
+			
+			snprintf( code, sizeof( code ), "\\u%04x", c );
+			escaped += code;
+		}
+		else {
+			
+			escaped += c;
+		}
+	}
+	
+	return escaped;
+}
+
+void Trace::reserve( size_t nameLength ) {
+	
+	// an event is never more than a couple hundred bytes besides its name
+	if( used + (int) nameLength > BUFFER_SIZE - 512 ) {
+		
+		flush();
+	}
+}
+
+bool Trace::flush() {
+	
+	if( fout == NULL ) {
+		
+		return false;
+	}
+	
+	bool flushed = ( (int) fwrite( buffer, 1, used, fout ) == used && fflush( fout ) == 0 );
+	
+	written += used;
+	used = 0;
+	
+	return flushed;
+}
+
+void Trace::name( const char *kind, int process, long track, const char *trackName ) {
+	
+	reserve( strlen( trackName ) );
+	
+	used += snprintf( buffer + used, BUFFER_SIZE - used, "%s\n{\"name\":\"%s\",\"ph\":\"M\",\"pid\":%d,\"tid\":%ld,\"args\":{\"name\":\"%s\"}}",
+					  ( traced() > 1 ? "," : "" ), kind, process, track, trackName );
+}
+
+// the trace counts in microseconds & the simulation in milliseconds
+void Trace::span( const char *spanName, int process, long track, long start, long end ) {
+	
+	reserve( strlen( spanName ) );
+	
+	used += snprintf( buffer + used, BUFFER_SIZE - used, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%ld,\"ts\":%ld,\"dur\":%ld}",
+					  spanName, process, track, start * 1000, ( end - start ) * 1000 );
+}
+
+void Trace::slice( int core, int PID, long start, long end ) {
+	
+	char spanName[ 32 ];
+	
+	snprintf( spanName, sizeof( spanName ), "PID %d", PID );
+	
+	span( spanName, CPU_TRACKS, core, start, end );
+	span( "run", JOB_TRACKS, PID, start, end );
+}
+
+void Trace::io( int device, int PID, long start, long end ) {
+	
+	char spanName[ 32 ];
+	vector<long> &channels = channelEnds[ device ];
+	int channel = 0;
+	
+	// the io goes on the first channel that is free, a track can only show
+	// one operation at a time
+	while( channel < (int) channels.size() - 1 && channels[ channel ] > start ) {
+		
+		channel++;
+	}
+	
+	channels[ channel ] = end;
+	snprintf( spanName, sizeof( spanName ), "PID %d", PID );
+	
+	span( spanName, DEVICE_TRACKS, firstChannel[ device ] + channel, start, end );
+	span( deviceNames[ device ].c_str(), JOB_TRACKS, PID, start, end );
+}
+
+void Trace::job( int PID, long arrival, long exit ) {
+	
+	char spanName[ 32 ];
+	
+	snprintf( spanName, sizeof( spanName ), "PID %d", PID );
+	
+	// the track of a job is named when it exits, so nothing has to be kept
+	// about the jobs that have not exited yet
+	name( "thread_name", JOB_TRACKS, PID, spanName );
+	span( spanName, JOB_TRACKS, PID, arrival, exit );
+}
+
+bool Trace::close() {
+	
+	if( fout == NULL ) {
+		
+		return true;
+	}
+	
+	buffer[ used++ ] = '\n';
+	buffer[ used++ ] = ']';
+	buffer[ used++ ] = '\n';
+	
+	bool closed = flush();
+	
+	closed = ( fclose( fout ) == 0 && closed );
+	fout = NULL;
+	
+	return closed;
+}
@@ -0,0 +1,379 @@
+#include "MetaDataParser.cpp"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+// the start of a trace cache file, the sections after it are found through
+// the offsets in it.. offsets are from the start of the file & every
+// section starts on a multiple of 8 so the arrays can be read where they are
+struct TraceCacheHeader {
+	
+	char magic[ 8 ];	// always OSTRACE & a 0
+	int version;	// goes up whenever the layout changes
+	int deviceCount;	// number of names in the device section
+	
+	long sourceSize;	// size of the metadata file the cache was made from
+	long sourceSeconds;	// modification time of the metadata file
+	long sourceNanoseconds;
+	
+	long jobCount;
+	long operationCount;
+	long fileSize;	// size the whole cache file should be
+	
+	long namesOffset;	// name of every device the operations use an id of, each ended by a 0
+	long jobsOffset;	// where the operations of every job are
+	long totalsOffset;	// cycles every job needs on every device
+	long typesOffset;	// type of every operation
+	long devicesOffset;	// device id of every operation
+	long cyclesOffset;	// cycles of every operation
+};
+
+// a job in the job section of the cache
+struct TraceCacheJob {
+	
+	int firstOperation;
+	int numberOfOperations;
+	long memory;	// memory ( KB ) the job needs
+};
+
+// the trace cache is the metadata compiled into a binary file next to it,
+// metadata.txt gets metadata.txt.cache.. once the cache is made a run maps
+// it & the operation table reads the operations straight out of the
+// mapping, so nothing is parsed or copied.. the cache remembers the size &
+// modification time of the metadata it was made from & is made again when
+// either changes.. it is only meant to be read on the machine that made it
+class TraceCache {
+	
+	public:
+		
+		static const int VERSION = 3;
+		
+		// constructor & destructor
+		TraceCache();
+		~TraceCache();
+		
+		// name of the cache file of the metadata file
+		static string cacheName( string );
+		
+		// maps the cache of the metadata file & puts its jobs in the job
+		// table, returns false if there is no cache that is up to date or
+		// it uses a device the device table does not know.. the mapping has
+		// to stay open while the job table is used
+		bool load( string, JobTable &, DeviceTable & );
+		
+		// writes the cache of the metadata file from the jobs in the table,
+		// the jobs have to be just as they were read from the metadata..
+		// the source is what the metadata file was before it was read, the
+		// cache is not written if the file changed while it was read
+		bool save( string, TraceCacheHeader &, JobTable &, DeviceTable & );
+		
+		// unmaps the cache
+		void close();
+		
+		// fills in the size & modification time of the metadata file
+		bool sourceInfo( string, TraceCacheHeader & );
+	
+	private:
+		
+		// true if the header is one this version wrote for the metadata
+		// file as it is now
+		bool matches( TraceCacheHeader &, TraceCacheHeader & );
+		
+		// true if both are the metadata file at the same size & time
+		bool sameSource( TraceCacheHeader &, TraceCacheHeader & );
+		
+		const char *data; // the mapped cache, NULL if there is none
+		size_t length;
+		
+		// the device ids of the operations when the cache numbers the
+		// devices differently than the device table
+		vector<int> remapped;
+};
+
+TraceCache::TraceCache() {
+	
+	data = NULL;
+	length = 0;
+}
+
+TraceCache::~TraceCache() {
+	
+	close();
+}
+
+string TraceCache::cacheName( string metadata ) {
+	
+	return ( metadata + ".cache" );
+}
+
+bool TraceCache::sourceInfo( string metadata, TraceCacheHeader &header ) {
+	
+	struct stat info;
+	
+	if( stat( metadata.c_str(), &info ) == -1 ) {
+		
+		return false;
+	}
+	
+	header.sourceSize = info.st_size;
+	header.sourceSeconds = info.st_mtim.tv_sec;
+	header.sourceNanoseconds = info.st_mtim.tv_nsec;
+	
+	return true;
+}
+
+bool TraceCache::matches( TraceCacheHeader &header, TraceCacheHeader &source ) {
+	
+	return ( memcmp( header.magic, "OSTRACE", 8 ) == 0 && header.version == VERSION && sameSource( header, source ) );
+}
+
+bool TraceCache::sameSource( TraceCacheHeader &a, TraceCacheHeader &b ) {
+	
+	return ( a.sourceSize == b.sourceSize && a.sourceSeconds == b.sourceSeconds && a.sourceNanoseconds == b.sourceNanoseconds );
+}
+
+bool TraceCache::load( string metadata, JobTable &jobs, DeviceTable &devices ) {
+	
+	TraceCacheHeader source;
+	struct stat info;
+	
+	close();
+	
+	if( !sourceInfo( metadata, source ) ) {
+		
+		return false;
+	}
+	
+	int fd = ::open( cacheName( metadata ).c_str(), O_RDONLY );
+	
+	if( fd == -1 ) {
+		
+		return false;
+	}
+	
+	if( fstat( fd, &info ) == -1 || info.st_size < (long) sizeof( TraceCacheHeader ) ) {
+		
+		::close( fd );
+		return false;
+	}
+	
+	void *mapping = mmap( NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+	
+	// the mapping keeps the file open, the descriptor is not needed anymore
+	::close( fd );
+	
+	if( mapping == MAP_FAILED ) {
+		
+		return false;
+	}
+	
+	data = (const char *) mapping;
+	length = info.st_size;
+	
+	TraceCacheHeader &header = *(TraceCacheHeader *) data;
+	
+	// a cache cut short ( like by a run that was killed while writing it )
+	// is not the size its header says
+	if( !matches( header, source ) || header.fileSize != (long) length ) {
+		
+		close();
+		return false;
+	}
+	
+	// the cache numbers the devices in the order they were registered when
+	// it was made, so every name is looked up in the device table of this
+	// run.. a device the table does not know means the config changed & the
+	// metadata has to be read again to find out what is wrong, devices no
+	// operation uses have no name & do not matter
+	vector<int> deviceIds;
+	const char *name = data + header.namesOffset;
+	bool sameIds = true;
+	
+	for( int i = 0; i < header.deviceCount; i++ ) {
+		
+		deviceIds.push_back( *name == '\0' ? -1 : devices.lookup( name ) );
+		
+		if( *name != '\0' && deviceIds[ i ] == -1 ) {
+			
+			close();
+			return false;
+		}
+		
+		sameIds = ( sameIds && ( deviceIds[ i ] == i || deviceIds[ i ] == -1 ) );
+		name += strlen( name ) + 1;
+	}
+	
+	const TraceCacheJob *cachedJobs = (const TraceCacheJob *) ( data + header.jobsOffset );
+	const long *totals = (const long *) ( data + header.totalsOffset );
+	const char *types = data + header.typesOffset;
+	const int *deviceOfOperation = (const int *) ( data + header.devicesOffset );
+	const int *cycles = (const int *) ( data + header.cyclesOffset );
+	
+	// only the device ids have to be copied when they do not line up, the
+	// types & cycles are still read from the mapping
+	if( !sameIds ) {
+		
+		remapped.resize( header.operationCount );
+		
+		for( long i = 0; i < header.operationCount; i++ ) {
+			
+			remapped[ i ] = deviceIds[ deviceOfOperation[ i ] ];
+		}
+		
+		deviceOfOperation = remapped.data();
+	}
+	
+	jobs.clear();
+	jobs.operations.view( types, deviceOfOperation, cycles, header.operationCount );
+	
+	// the jobs themselves change as they run so they are made in the table,
+	// the time to process a job comes from its cycles on each device
+	// instead of going over every operation of it
+	for( long i = 0; i < header.jobCount; i++ ) {
+		
+		Job &job = jobs[ jobs.createJob() ];
+		
+		job.firstOperation = cachedJobs[ i ].firstOperation;
+		job.numberOfOperations = cachedJobs[ i ].numberOfOperations;
+		job.memory = cachedJobs[ i ].memory;
+		
+		if( job.numberOfOperations > 0 ) {
+			
+			job.remainingCycles = cycles[ job.firstOperation ];
+		}
+		
+		for( int d = 0; d < header.deviceCount; d++ ) {
+			
+			if( deviceIds[ d ] == -1 ) {
+				
+				continue;
+			}
+			
+			job.timeToProcessJob += devices.cost( deviceIds[ d ], totals[ i * header.deviceCount + d ] );
+		}
+	}
+	
+	return true;
+}
+
+bool TraceCache::save( string metadata, TraceCacheHeader &source, JobTable &jobs, DeviceTable &devices ) {
+	
+	TraceCacheHeader header;
+	OperationTable &table = jobs.ops();
+	
+	memset( &header, 0, sizeof( header ) );
+	
+	// the jobs are what was in the file before it was read, if it was
+	// written to since then they could be some of each.. the next run
+	// parses it again
+	if( !sourceInfo( metadata, header ) || !sameSource( header, source ) ) {
+		
+		return false;
+	}
+	
+	memcpy( header.magic, "OSTRACE", 8 );
+	header.version = VERSION;
+	header.deviceCount = devices.size();
+	header.jobCount = jobs.size();
+	header.operationCount = table.size();
+	
+	// the cycles of every job on every device are added up here once, so
+	// a run with different cycle times does not have to look at every
+	// operation to cost the jobs
+	vector<TraceCacheJob> cachedJobs( header.jobCount );
+	vector<long> totals( header.jobCount * header.deviceCount, 0 );
+	vector<bool> used( header.deviceCount, false );
+	
+	for( int i = 0; i < jobs.size(); i++ ) {
+		
+		cachedJobs[ i ].firstOperation = jobs[ i ].firstOperation;
+		cachedJobs[ i ].numberOfOperations = jobs[ i ].numberOfOperations;
+		cachedJobs[ i ].memory = jobs[ i ].memory;
+		
+		for( int j = 0; j < jobs[ i ].numberOfOperations; j++ ) {
+			
+			int index = jobs[ i ].firstOperation + j;
+			
+			totals[ (long) i * header.deviceCount + table.device( index ) ] += table.cycles( index );
+			used[ table.device( index ) ] = true;
+		}
+	}
+	
+	// only the devices the metadata uses are named, a config without one
+	// of the others can still use the cache
+	string names;
+	
+	for( int i = 0; i < devices.size(); i++ ) {
+		
+		names += ( used[ i ] ? devices.name( i ) : "" );
+		names += '\0';
+	}
+	
+	// lay the sections out one after another, each on a multiple of 8
+	long offset = sizeof( header );
+	long *offsets[] = { &header.namesOffset, &header.jobsOffset, &header.totalsOffset,
+						&header.typesOffset, &header.devicesOffset, &header.cyclesOffset };
+	long sizes[] = { (long) names.size(), header.jobCount * (long) sizeof( TraceCacheJob ),
+					 (long) ( totals.size() * sizeof( long ) ), header.operationCount,
+					 header.operationCount * (long) sizeof( int ), header.operationCount * (long) sizeof( int ) };
+	const void *sections[] = { names.data(), cachedJobs.data(), totals.data(),
+							   table.types.data(), table.devices.data(), table.cycleTimes.data() };
+	
+	for( int i = 0; i < 6; i++ ) {
+		
+		*offsets[ i ] = offset;
+		offset = ( offset + sizes[ i ] + 7 ) / 8 * 8;
+	}
+	
+	header.fileSize = offset;
+	
+	// the cache is written next to it & renamed over the old one once it
+	// is complete, so a run never maps half a cache
+	string temporary = cacheName( metadata ) + ".tmp";
+	FILE *fout = fopen( temporary.c_str(), "wb" );
+	
+	if( fout == NULL ) {
+		
+		return false;
+	}
+	
+	bool written = ( fwrite( &header, sizeof( header ), 1, fout ) == 1 );
+	char padding[ 8 ] = { 0 };
+	
+	for( int i = 0; i < 6 && written; i++ ) {
+		
+		long end = ( i < 5 ? *offsets[ i + 1 ] : header.fileSize );
+		
+		written = ( fwrite( sections[ i ], 1, sizes[ i ], fout ) == (size_t) sizes[ i ] &&
+					fwrite( padding, 1, end - *offsets[ i ] - sizes[ i ], fout ) == (size_t) ( end - *offsets[ i ] - sizes[ i ] ) );
+	}
+	
+	written = ( fclose( fout ) == 0 && written );
+	
+	if( !written || rename( temporary.c_str(), cacheName( metadata ).c_str() ) != 0 ) {
+		
+		unlink( temporary.c_str() );
+		return false;
+	}
+	
+	return true;
+}
+
+void TraceCache::close() {
+	
+	if( data != NULL ) {
+		
+		munmap( (void *) data, length );
+		data = NULL;
+		length = 0;
+	}
+	
+	remapped.clear();
+}
@@ -0,0 +1,304 @@
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// a number in the workload that is drawn at random for every job or
+// operation, written in the workload file as one of
+//
+//	fixed 5			- always 5
+//	uniform 1 20		- anything from 1 to 20, all as likely
+//	exponential 8		- mostly short with a few long ones, 8 on average
+//
+// nothing drawn is ever less than 1
+struct Distribution {
+	
+	// constructor, a distribution that is always the number
+	Distribution( long number = 1 ) {
+		
+		kind = "fixed";
+		low = number;
+		high = number;
+		mean = number;
+	}
+	
+	// reads the distribution from its text, returns false if it is bad
+	bool read( string );
+	
+	// draws the next number
+	long draw( mt19937_64 & );
+	
+	string kind;	// fixed, uniform or exponential
+	long low;
+	long high;
+	double mean;
+};
+
+bool Distribution::read( string text ) {
+	
+	stringstream words( text );
+	
+	words >> kind;
+	
+	if( kind == "fixed" ) {
+		
+		words >> low;
+		high = low;
+	}
+	else if( kind == "uniform" ) {
+		
+		words >> low >> high;
+	}
+	else if( kind == "exponential" ) {
+		
+		words >> mean;
+	}
+	else {
+		
+		return false;
+	}
+	
+	return ( !words.fail() && low >= 1 && high >= low && mean > 0 );
+}
+
+long Distribution::draw( mt19937_64 &random ) {
+	
+	if( kind == "uniform" ) {
+		
+		return uniform_int_distribution<long>( low, high )( random );
+	}
+	
+	if( kind == "exponential" ) {
+		
+		return max( 1L, lround( exponential_distribution<double>( 1.0 / mean )( random ) ) );
+	}
+	
+	return low;
+}
+
+// the workload generator writes metadata files of any size with jobs
+// made up at random from the settings of a workload file.. the same
+// settings & seed always make the same file on the same machine, so a
+// workload can be made again instead of being kept around
+class WorkloadGenerator {
+	
+	public:
+		
+		// constructor, the settings start out like the sample metadata
+		WorkloadGenerator();
+		
+		// reads the settings from a workload file, returns false if one is bad
+		bool readSettings( string );
+		
+		// writes the metadata file, returns false if it could not be written
+		bool generate( string );
+		
+		long jobs; // number of jobs in the file
+		unsigned long seed; // starts the random numbers
+		
+		Distribution cpuBursts; // P operations in every job, there is io between each of them
+		Distribution cpuCycles; // cycles of every P operation
+		Distribution ioCycles; // cycles of every I or O operation
+		Distribution jobMemory; // memory ( KB ) every job needs
+		bool withMemory; // jobs say how much memory they need, off unless a job memory is set
+		
+		// the io operations to pick from, like I(keyboard), & how likely
+		// each is compared to the others
+		vector<string> devices;
+		vector<double> weights;
+		
+		long operations; // operations written to the last file, not counting A & S
+	
+	private:
+		
+		// puts the operation on the end of the text, like P(run)13;
+		void writeOperation( string &, const string &, long );
+};
+
+WorkloadGenerator::WorkloadGenerator() {
+	
+	jobs = 1000000;
+	seed = 1;
+	operations = 0;
+	withMemory = false;
+	
+	cpuBursts.read( "uniform 1 8" );
+	cpuCycles.read( "uniform 1 20" );
+	ioCycles.read( "uniform 1 6" );
+	
+	devices = { "I(keyboard)", "O(monitor)", "I(hard drive)", "O(hard drive)", "O(printer)" };
+	weights = { 1, 1, 1, 1, 1 };
+}
+
+// the workload file has a line for each setting it changes, like
+// Jobs: 1000000
+// Seed: 7
+// Cpu bursts: uniform 1 8
+// Cpu cycles: exponential 10
+// Io cycles: fixed 5
+// Job memory: uniform 16 256
+// Device mix: I(keyboard) 1, O(monitor) 2, I(hard drive) 4, O(hard drive) 4
+bool WorkloadGenerator::readSettings( string filename ) {
+	
+	ifstream fin( filename.c_str() );
+	string line;
+	
+	if( !fin ) {
+		
+		cerr << "Error: " << filename << ": could not open workload file" << endl;
+		return false;
+	}
+	
+	while( getline( fin, line ) ) {
+		
+		size_t colon = line.find( ':' );
+		
+		if( colon == string::npos ) {
+			
+			continue;
+		}
+		
+		string name = line.substr( 0, colon );
+		string value = line.substr( colon + 1 );
+		bool good = true;
+		
+		if( name == "Jobs" ) {
+			
+			jobs = atol( value.c_str() );
+			good = ( jobs > 0 );
+		}
+		else if( name == "Seed" ) {
+			
+			seed = strtoul( value.c_str(), NULL, 10 );
+		}
+		else if( name == "Cpu bursts" ) {
+			
+			good = cpuBursts.read( value );
+		}
+		else if( name == "Cpu cycles" ) {
+			
+			good = cpuCycles.read( value );
+		}
+		else if( name == "Io cycles" ) {
+			
+			good = ioCycles.read( value );
+		}
+		else if( name == "Job memory" ) {
+			
+			good = jobMemory.read( value );
+			withMemory = true;
+		}
+		// every entry is the operation & its weight, separated by commas
+		else if( name == "Device mix" ) {
+			
+			string entry;
+			stringstream entries( value );
+			
+			devices.clear();
+			weights.clear();
+			
+			while( getline( entries, entry, ',' ) ) {
+				
+				size_t close = entry.find( ')' );
+				size_t open = entry.find_first_not_of( " \t" );
+				
+				if( close == string::npos || ( entry[ open ] != 'I' && entry[ open ] != 'O' ) ) {
+					
+					good = false;
+					break;
+				}
+				
+				devices.push_back( entry.substr( open, close - open + 1 ) );
+				weights.push_back( atof( entry.c_str() + close + 1 ) );
+			}
+			
+			good = ( good && !devices.empty() );
+		}
+		
+		if( !good ) {
+			
+			cerr << "Error: " << filename << ": bad setting \"" << line << "\"" << endl;
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+void WorkloadGenerator::writeOperation( string &text, const string &operation, long cycles ) {
+	
+	char number[ 24 ];
+	
+	text += operation;
+	text.append( number, to_chars( number, number + sizeof( number ), cycles ).ptr - number );
+	text += "; ";
+}
+
+bool WorkloadGenerator::generate( string filename ) {
+	
+	FILE *fout = fopen( filename.c_str(), "w" );
+	
+	if( fout == NULL ) {
+		
+		cerr << "Error: " << filename << ": could not write metadata file" << endl;
+		return false;
+	}
+	
+	mt19937_64 random( seed );
+	discrete_distribution<int> pickDevice( weights.begin(), weights.end() );
+	string text = "S(start)0;\n";
+	bool written = true;
+	
+	operations = 0;
+	
+	// a job per line, the text is written out in big pieces so a file of
+	// millions of jobs is not held in memory
+	for( long j = 0; j < jobs && written; j++ ) {
+		
+		long bursts = cpuBursts.draw( random );
+		
+		text += "A(start)0; ";
+		
+		if( withMemory ) {
+			
+			writeOperation( text, "M(allocate)", jobMemory.draw( random ) );
+		}
+		
+		for( long i = 0; i < bursts; i++ ) {
+			
+			writeOperation( text, "P(run)", cpuCycles.draw( random ) );
+			
+			if( i < bursts - 1 ) {
+				
+				writeOperation( text, devices[ pickDevice( random ) ], ioCycles.draw( random ) );
+			}
+		}
+		
+		operations += 2 * bursts - 1;
+		text += "A(end)0;\n";
+		
+		if( text.size() > ( 1 << 20 ) ) {
+			
+			written = ( fwrite( text.data(), 1, text.size(), fout ) == text.size() );
+			text.clear();
+		}
+	}
+	
+	text += "S(end)0.\n";
+	written = ( written && fwrite( text.data(), 1, text.size(), fout ) == text.size() );
+	written = ( fclose( fout ) == 0 && written );
+	
+	if( !written ) {
+		
+		cerr << "Error: " << filename << ": could not write metadata file" << endl;
+	}
+	
+	return written;
+}
@@ -1,13 +1,83 @@
-#include "OS.cpp"
+#include "Benchmark.cpp"
 
 using namespace std;
 
-int main() {
+int main( int argc, char *argv[] ) {
+	
+	// --profile can go in front of anything else, the time every phase &
+	// scheduler function took is printed once the run is over.. only a
+	// simulator built with -DPROFILE has the profiler in it
+	if( argc > 1 && string( argv[ 1 ] ) == "--profile" ) {
+
+#ifdef PROFILE
+		profiler.enable();
+		atexit( []() { profiler.report(); } );
+#else
+		cerr << "Error: --profile needs the simulator to be built with -DPROFILE" << endl;
+#endif
+		
+		argv[ 1 ] = argv[ 0 ];
+		argv++;
+		argc--;
+	}
+	
+	// with --sweep every combination of the settings in the sweep file is
+	// run on the workload of the config file & compared, instead of
+	// running the config file once.. ./simulator --sweep sweep.txt config.txt
+	if( argc > 2 && string( argv[ 1 ] ) == "--sweep" ) {
+		
+		Sweep sweep( argv[ 2 ], ( argc > 3 ? argv[ 3 ] : "config.txt" ) );
+		
+		return 0;
+	}
+	
+	// makes a metadata file from the settings of a workload file, like
+	// ./simulator --generate workload.txt metadata.txt
+	if( argc > 3 && string( argv[ 1 ] ) == "--generate" ) {
+		
+		WorkloadGenerator generator;
+		
+		return ( generator.readSettings( argv[ 2 ] ) && generator.generate( argv[ 3 ] ) ? 0 : 1 );
+	}
+	
+	// times the simulator on generated workloads of the sizes given, like
+	// ./simulator --benchmark config.txt workload.txt 10000 1000000.. the
+	// config & workload file can be left out, every other argument is a size
+	if( argc > 1 && string( argv[ 1 ] ) == "--benchmark" ) {
+		
+		vector<string> files;
+		vector<long> sizes;
+		
+		for( int i = 2; i < argc; i++ ) {
+			
+			if( isdigit( argv[ i ][ 0 ] ) ) {
+				
+				sizes.push_back( atol( argv[ i ] ) );
+			}
+			else {
+				
+				files.push_back( argv[ i ] );
+			}
+		}
+		
+		if( sizes.empty() ) {
+			
+			sizes = { 10000, 100000, 1000000 };
+		}
+		
+		Benchmark benchmark( ( files.size() > 0 ? files[ 0 ] : "config.txt" ), ( files.size() > 1 ? files[ 1 ] : "" ), sizes );
+		
+		return 0;
+	}
+	
+	// --resume carries on a run that was stopped from its last checkpoint,
+	// the log comes out the same as if it had never stopped
+	bool resume = ( argc > 1 && string( argv[ 1 ] ) == "--resume" );
 	
 	// need to replace filename with command line parameter
 	// config.txt should open the file which contains the 
 	// file with the configuration settings.
-	OS operatingSystem( "config.txt" );
+	OS operatingSystem( "config.txt", resume );
 	
 	return 0;
 }
@@ -0,0 +1,57 @@
+#!/bin/bash
+# streaming has to come out the same every run however fast the metadata
+# is read, & the same as loading everything first once the window holds
+# every job.. run from anywhere, like tests/stream_determinism.sh
+
+repo=$( cd "$( dirname "$0" )/.." && pwd )
+work=$( mktemp -d )
+trap 'rm -rf "$work"' EXIT
+
+g++ -std=c++17 -O2 -pthread "$repo/main.cpp" -o "$work/simulator" || exit 1
+cd "$work"
+
+sed 's/Jobs: .*/Jobs: 3000/' "$repo/workload.txt" > workload.txt
+./simulator --generate workload.txt metadata.txt || exit 1
+
+# the repo config with the settings given added on the end
+configure() {
+
+	{ sed -e "s#Filepath: .*#Filepath: metadata.txt#" -e "s/Log: .*/Log: Log to File/" -e "s/Processor Scheduling: .*/Processor Scheduling: $1/" \
+		  "$repo/config.txt" | grep -v "End Simulator"
+	  echo "Log level: jobs"
+	  echo "Trace cache: off"
+	  printf "$2"
+	  echo "End Simulator Configuration File"; } > config.txt
+}
+
+failed=0
+
+for policy in "FIFO" "Round Robin"; do
+
+	for window in 200 5000; do
+
+		configure "$policy" "Streaming window (jobs): $window\n"
+
+		./simulator > /dev/null && mv log.txt first.txt
+		./simulator > /dev/null && mv log.txt second.txt
+
+		if ! cmp -s first.txt second.txt; then
+
+			echo "FAIL: $policy with a window of $window came out different on two runs"
+			failed=1
+		fi
+	done
+
+	# the last window holds every job, so they all arrive at time 0
+	configure "$policy" ""
+	./simulator > /dev/null
+
+	if ! cmp -s log.txt second.txt; then
+
+		echo "FAIL: $policy streamed with room for every job is not the same as loading them"
+		failed=1
+	fi
+done
+
+[ $failed -eq 0 ] && echo "streaming is deterministic"
+exit $failed